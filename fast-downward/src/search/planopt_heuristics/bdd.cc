@@ -0,0 +1,193 @@
+#include "bdd.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+namespace planopt_heuristics {
+static const size_t CACHE_SIZE = 1 << 18;
+
+BDDManager::BDDManager(int num_variables)
+    : num_variables(num_variables),
+      cache(CACHE_SIZE, CacheEntry {-1, 0, 0, 0}) {
+    // The terminal nodes are below all variables.
+    nodes.push_back(Node {num_variables, FALSE_BDD, FALSE_BDD});
+    nodes.push_back(Node {num_variables, TRUE_BDD, TRUE_BDD});
+}
+
+BDD BDDManager::make_node(int var, BDD low, BDD high) {
+    if (low == high)
+        return low;
+    Node node {var, low, high};
+    auto it = unique_table.find(node);
+    if (it != unique_table.end())
+        return it->second;
+    BDD bdd = nodes.size();
+    nodes.push_back(node);
+    unique_table[node] = bdd;
+    return bdd;
+}
+
+BDD BDDManager::make_cube(const vector<int> &values) {
+    assert(static_cast<int>(values.size()) == num_variables);
+    BDD result = TRUE_BDD;
+    for (int var = num_variables - 1; var >= 0; --var) {
+        if (values[var] == 0) {
+            result = make_node(var, result, FALSE_BDD);
+        } else if (values[var] == 1) {
+            result = make_node(var, FALSE_BDD, result);
+        }
+    }
+    return result;
+}
+
+BDD BDDManager::apply(Operation operation, BDD left, BDD right) {
+    switch (operation) {
+    case Operation::AND:
+        if (left == FALSE_BDD || right == FALSE_BDD)
+            return FALSE_BDD;
+        if (left == TRUE_BDD)
+            return right;
+        if (right == TRUE_BDD || left == right)
+            return left;
+        if (left > right)
+            swap(left, right);
+        break;
+    case Operation::OR:
+        if (left == TRUE_BDD || right == TRUE_BDD)
+            return TRUE_BDD;
+        if (left == FALSE_BDD)
+            return right;
+        if (right == FALSE_BDD || left == right)
+            return left;
+        if (left > right)
+            swap(left, right);
+        break;
+    case Operation::AND_NOT:
+        if (left == FALSE_BDD || right == TRUE_BDD || left == right)
+            return FALSE_BDD;
+        if (right == FALSE_BDD)
+            return left;
+        break;
+    }
+
+    int operation_id = static_cast<int>(operation);
+    size_t slot = (static_cast<size_t>(left) * 12582917u +
+                   static_cast<size_t>(right) * 4256249u + operation_id) % CACHE_SIZE;
+    CacheEntry &entry = cache[slot];
+    if (entry.operation == operation_id && entry.left == left && entry.right == right)
+        return entry.result;
+
+    int var = min(get_var(left), get_var(right));
+    BDD left_low = left, left_high = left;
+    if (get_var(left) == var) {
+        left_low = nodes[left].low;
+        left_high = nodes[left].high;
+    }
+    BDD right_low = right, right_high = right;
+    if (get_var(right) == var) {
+        right_low = nodes[right].low;
+        right_high = nodes[right].high;
+    }
+    BDD low = apply(operation, left_low, right_low);
+    BDD high = apply(operation, left_high, right_high);
+    BDD result = make_node(var, low, high);
+
+    // The recursive calls may have overwritten the entry.
+    CacheEntry &new_entry = cache[slot];
+    new_entry.operation = operation_id;
+    new_entry.left = left;
+    new_entry.right = right;
+    new_entry.result = result;
+    return result;
+}
+
+BDD BDDManager::restrict_recursive(
+    BDD bdd, const vector<int> &values, unordered_map<BDD, BDD> &results) {
+    if (bdd == FALSE_BDD || bdd == TRUE_BDD)
+        return bdd;
+    auto it = results.find(bdd);
+    if (it != results.end())
+        return it->second;
+    const Node &node = nodes[bdd];
+    int var = node.var;
+    BDD low = node.low;
+    BDD high = node.high;
+    BDD result;
+    if (values[var] == 0) {
+        result = restrict_recursive(low, values, results);
+    } else if (values[var] == 1) {
+        result = restrict_recursive(high, values, results);
+    } else {
+        BDD new_low = restrict_recursive(low, values, results);
+        BDD new_high = restrict_recursive(high, values, results);
+        result = make_node(var, new_low, new_high);
+    }
+    results[bdd] = result;
+    return result;
+}
+
+BDD BDDManager::restrict(BDD bdd, const vector<int> &values) {
+    assert(static_cast<int>(values.size()) == num_variables);
+    unordered_map<BDD, BDD> results;
+    return restrict_recursive(bdd, values, results);
+}
+
+bool BDDManager::evaluate(BDD bdd, const vector<int> &assignment) const {
+    while (bdd != FALSE_BDD && bdd != TRUE_BDD) {
+        const Node &node = nodes[bdd];
+        bdd = assignment[node.var] ? node.high : node.low;
+    }
+    return bdd == TRUE_BDD;
+}
+
+void BDDManager::collect_garbage(const vector<BDD *> &roots) {
+    /*
+      Children always have smaller indices than their parents, so we can
+      mark all reachable nodes in one pass from the back and then compact
+      the node vector in one pass from the front.
+    */
+    vector<bool> reachable(nodes.size(), false);
+    reachable[FALSE_BDD] = true;
+    reachable[TRUE_BDD] = true;
+    for (BDD *root : roots) {
+        reachable[*root] = true;
+    }
+    for (size_t i = nodes.size(); i-- > 2;) {
+        if (reachable[i]) {
+            reachable[nodes[i].low] = true;
+            reachable[nodes[i].high] = true;
+        }
+    }
+
+    vector<BDD> new_index(nodes.size(), -1);
+    vector<Node> new_nodes;
+    unique_table.clear();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (!reachable[i])
+            continue;
+        Node node = nodes[i];
+        if (i > TRUE_BDD) {
+            node.low = new_index[node.low];
+            node.high = new_index[node.high];
+        }
+        new_index[i] = new_nodes.size();
+        if (i > TRUE_BDD)
+            unique_table[node] = new_nodes.size();
+        new_nodes.push_back(node);
+    }
+    nodes.swap(new_nodes);
+    for (BDD *root : roots) {
+        *root = new_index[*root];
+    }
+    fill(cache.begin(), cache.end(), CacheEntry {-1, 0, 0, 0});
+}
+
+size_t BDDManager::get_memory_usage_in_bytes() const {
+    // We approximate an entry of the unique table as a node plus two pointers.
+    return nodes.capacity() * sizeof(Node) +
+           unique_table.size() * (sizeof(Node) + sizeof(BDD) + 2 * sizeof(void *)) +
+           cache.capacity() * sizeof(CacheEntry);
+}
+}
@@ -0,0 +1,119 @@
+#ifndef PLANOPT_HEURISTICS_BDD_H
+#define PLANOPT_HEURISTICS_BDD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  A BDD is represented by the index of its root node in a BDDManager. The
+  indices 0 and 1 are the constant functions false and true.
+*/
+using BDD = int;
+
+/*
+  Minimal package for reduced ordered binary decision diagrams over a fixed
+  number of boolean variables 0, ..., n-1 (variable 0 is at the top).
+
+  Nodes are never freed implicitly. Instead, the owner calls
+  collect_garbage() with all BDDs it still needs, which removes all other
+  nodes and renumbers the given BDDs.
+*/
+class BDDManager {
+    struct Node {
+        int var;
+        BDD low;
+        BDD high;
+    };
+
+    struct NodeHash {
+        std::size_t operator()(const Node &node) const {
+            std::uint64_t hash = static_cast<std::uint64_t>(node.var) * 0x9e3779b97f4a7c15ULL;
+            hash ^= static_cast<std::uint64_t>(node.low) + 0x7f4a7c159e3779b9ULL + (hash << 6) + (hash >> 2);
+            hash ^= static_cast<std::uint64_t>(node.high) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+    };
+
+    struct NodeEqual {
+        bool operator()(const Node &node1, const Node &node2) const {
+            return node1.var == node2.var && node1.low == node2.low &&
+                   node1.high == node2.high;
+        }
+    };
+
+    enum class Operation {
+        AND,
+        OR,
+        AND_NOT
+    };
+
+    /*
+      Direct-mapped cache of results of binary operations. Entries are
+      overwritten on collisions, so the cache has a fixed size.
+    */
+    struct CacheEntry {
+        int operation;
+        BDD left;
+        BDD right;
+        BDD result;
+    };
+
+    int num_variables;
+    std::vector<Node> nodes;
+    std::unordered_map<Node, BDD, NodeHash, NodeEqual> unique_table;
+    std::vector<CacheEntry> cache;
+
+    BDD make_node(int var, BDD low, BDD high);
+    int get_var(BDD bdd) const {
+        return nodes[bdd].var;
+    }
+    BDD apply(Operation operation, BDD left, BDD right);
+    BDD restrict_recursive(BDD bdd, const std::vector<int> &values,
+                           std::unordered_map<BDD, BDD> &results);
+public:
+    static const BDD FALSE_BDD = 0;
+    static const BDD TRUE_BDD = 1;
+
+    explicit BDDManager(int num_variables);
+
+    // Return the conjunction of the literals var = values[var] for all
+    // variables with values[var] != -1.
+    BDD make_cube(const std::vector<int> &values);
+
+    BDD bdd_and(BDD left, BDD right) {
+        return apply(Operation::AND, left, right);
+    }
+    BDD bdd_or(BDD left, BDD right) {
+        return apply(Operation::OR, left, right);
+    }
+    // Return left and not right.
+    BDD bdd_and_not(BDD left, BDD right) {
+        return apply(Operation::AND_NOT, left, right);
+    }
+    /*
+      Return the cofactor of the BDD that sets every variable var with
+      values[var] != -1 to values[var]. The result does not depend on these
+      variables.
+    */
+    BDD restrict(BDD bdd, const std::vector<int> &values);
+
+    // Evaluate the BDD under a full assignment of all variables.
+    bool evaluate(BDD bdd, const std::vector<int> &assignment) const;
+
+    /*
+      Remove all nodes that are not reachable from the given BDDs and
+      update the BDDs to the new node indices.
+    */
+    void collect_garbage(const std::vector<BDD *> &roots);
+
+    std::size_t get_num_nodes() const {
+        return nodes.size();
+    }
+    std::size_t get_memory_usage_in_bytes() const;
+};
+}
+
+#endif
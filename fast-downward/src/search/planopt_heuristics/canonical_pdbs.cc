@@ -1,6 +1,11 @@
 #include "canonical_pdbs.h"
 
 #include "../algorithms/max_cliques.h"
+#include "../utils/logging.h"
+#include "../utils/memory.h"
+#include "../utils/timer.h"
+
+#include <algorithm>
 
 using namespace std;
 
@@ -68,35 +73,282 @@ vector<vector<int>> build_compatibility_graph(const vector<Pattern> &patterns, c
     return graph;
 }
 
+int compute_max_additive_sum(
+    const vector<vector<int>> &maximal_additive_sets,
+    const vector<int> &heuristic_values) {
+    // Infinite values would overflow in the sums below.
+    for (int value : heuristic_values) {
+        if (value == numeric_limits<int>::max()) {
+            return numeric_limits<int>::max();
+        }
+    }
+
+    int h = 0;
+
+    for(unsigned int clique = 0; clique < maximal_additive_sets.size(); clique++){ // iterates through each clique in maximal_additive_sets
+        int sum = 0;
+        for(auto pdb : maximal_additive_sets[clique]){ // for each pdb in the clique, add its heuristic value to sum
+            sum += heuristic_values[pdb];
+        }
+        if(sum>h) // selects the greatest value of sum as the heuristic value
+            h = sum;
+    }
+
+    return h;
+}
+
 CanonicalPatternDatabases::CanonicalPatternDatabases(
-    const TNFTask &task, const vector<Pattern> &patterns) {
+    const TNFTask &task, const vector<Pattern> &patterns,
+    const PDBSettings &settings, int cache_size)
+    : num_redundant_pdbs(0),
+      redundant_table_bytes(0),
+      num_lookups(0),
+      num_evaluated_cliques(0) {
+    utils::Timer pdb_timer;
     for (const Pattern &pattern : patterns) {
-        pdbs.emplace_back(task, pattern);
+        pdbs.emplace_back(task, pattern, settings);
     }
+    pdb_construction_time = pdb_timer();
+    initialize(task, settings, cache_size);
+}
+
+CanonicalPatternDatabases::CanonicalPatternDatabases(
+    const TNFTask &task, vector<PatternDatabase> &&pdbs,
+    const PDBSettings &settings, int cache_size)
+    : pdbs(move(pdbs)),
+      num_redundant_pdbs(0),
+      redundant_table_bytes(0),
+      pdb_construction_time(0),
+      num_lookups(0),
+      num_evaluated_cliques(0) {
+    initialize(task, settings, cache_size);
+}
 
-    vector<vector<int>> compatibility_graph = build_compatibility_graph(patterns, task);
+void CanonicalPatternDatabases::initialize(
+    const TNFTask &task, const PDBSettings &settings, int cache_size) {
+    /*
+      Order the PDBs by size, so the small tables are stored next to each
+      other in the bank and the lookups of the large tables come last.
+    */
+    stable_sort(pdbs.begin(), pdbs.end(),
+                [](const PatternDatabase &pdb1, const PatternDatabase &pdb2) {
+                    return pdb1.get_statistics().num_abstract_states <
+                           pdb2.get_statistics().num_abstract_states;
+                });
+
+    utils::Timer compatibility_graph_timer;
+    vector<vector<int>> compatibility_graph = build_compatibility_graph(get_patterns(), task);
+    compatibility_graph_time = compatibility_graph_timer();
+
+    utils::Timer clique_timer;
     max_cliques::compute_max_cliques(compatibility_graph, maximal_additive_sets);
+    clique_time = clique_timer();
+
+    /*
+      Truncated and lossily compressed PDBs can be weaker than PDBs for
+      subsets of their patterns, so we only remove PDBs with exact values.
+    */
+    if (!settings.is_bounded() && settings.compression != PDBCompression::MIN) {
+        remove_redundant_pdbs(compatibility_graph);
+    }
+
+    if (PDBBank::supports(pdbs)) {
+        bank = utils::make_unique_ptr<PDBBank>(pdbs);
+    }
+    for (size_t i = 0; i < pdbs.size(); ++i) {
+        if (pdbs[i].has_dead_end_bitmap()) {
+            dead_end_order.push_back(i);
+        }
+    }
+    num_dead_end_checks.resize(pdbs.size(), 0);
+    num_dead_end_prunes.resize(pdbs.size(), 0);
+    rank_updates.resize(task.operators.size());
+    for (size_t i = 0; i < pdbs.size(); ++i) {
+        vector<vector<int>> changed_positions =
+            get_changed_pattern_positions(task, pdbs[i].get_pattern());
+        for (size_t op_id = 0; op_id < task.operators.size(); ++op_id) {
+            if (!changed_positions[op_id].empty()) {
+                rank_updates[op_id].push_back({static_cast<int>(i), move(changed_positions[op_id])});
+            }
+        }
+    }
+
+    if (cache_size > 0) {
+        cache = utils::make_unique_ptr<HeuristicCache>(static_cast<int>(pdbs.size()), cache_size);
+    }
+}
+
+static bool is_subset(const Pattern &subset, const Pattern &superset) {
+    return includes(superset.begin(), superset.end(), subset.begin(), subset.end());
+}
+
+static void remove_vertex(vector<vector<int>> &graph, int vertex) {
+    graph.erase(graph.begin() + vertex);
+    for (vector<int> &successors : graph) {
+        successors.erase(remove(successors.begin(), successors.end(), vertex),
+                         successors.end());
+        for (int &successor : successors) {
+            if (successor > vertex)
+                --successor;
+        }
+    }
+}
+
+bool CanonicalPatternDatabases::is_dominated_in_all_cliques(
+    int pdb_index, int dominating_pdb_index) const {
+    for (const vector<int> &clique : maximal_additive_sets) {
+        if (find(clique.begin(), clique.end(), pdb_index) == clique.end())
+            continue;
+        vector<int> required;
+        for (int member : clique) {
+            if (member != pdb_index)
+                required.push_back(member);
+        }
+        required.push_back(dominating_pdb_index);
+        sort(required.begin(), required.end());
+        bool has_counterpart = false;
+        for (const vector<int> &other_clique : maximal_additive_sets) {
+            vector<int> sorted_clique = other_clique;
+            sort(sorted_clique.begin(), sorted_clique.end());
+            if (!binary_search(sorted_clique.begin(), sorted_clique.end(), pdb_index) &&
+                includes(sorted_clique.begin(), sorted_clique.end(),
+                         required.begin(), required.end())) {
+                has_counterpart = true;
+                break;
+            }
+        }
+        if (!has_counterpart)
+            return false;
+    }
+    return true;
+}
 
+void CanonicalPatternDatabases::remove_redundant_pdbs(
+    vector<vector<int>> &compatibility_graph) {
+    /*
+      The PDB for a subset P of a pattern Q never has a higher value than
+      the PDB for Q. If every maximal clique C containing P has a
+      counterpart that contains (C without P) plus Q but not P, the sum
+      over C is never larger than the sum over the counterpart. Removing P
+      then does not change the maximum over the remaining cliques, which
+      are all contained in the maximal cliques of the graph without P.
+
+      We remove one PDB at a time and recompute the cliques, since removing
+      a PDB can change which of the other PDBs are redundant.
+    */
+    vector<Pattern> sorted_patterns = get_patterns();
+    for (Pattern &pattern : sorted_patterns) {
+        sort(pattern.begin(), pattern.end());
+    }
+    bool removed_pdb = true;
+    while (removed_pdb) {
+        removed_pdb = false;
+        for (size_t i = 0; i < pdbs.size() && !removed_pdb; ++i) {
+            for (size_t j = 0; j < pdbs.size(); ++j) {
+                if (i == j || !is_subset(sorted_patterns[i], sorted_patterns[j]) ||
+                    !is_dominated_in_all_cliques(i, j))
+                    continue;
+                ++num_redundant_pdbs;
+                redundant_table_bytes += pdbs[i].get_statistics().table_bytes;
+                pdbs.erase(pdbs.begin() + i);
+                sorted_patterns.erase(sorted_patterns.begin() + i);
+                remove_vertex(compatibility_graph, i);
+                maximal_additive_sets.clear();
+                max_cliques::compute_max_cliques(compatibility_graph, maximal_additive_sets);
+                removed_pdb = true;
+                break;
+            }
+        }
+    }
 }
 
 int CanonicalPatternDatabases::compute_heuristic(const TNFState &original_state) {
+    compute_abstract_state_indices(original_state, abstract_state_indices);
+    return compute_heuristic_of_abstract_states(abstract_state_indices);
+}
+
+void CanonicalPatternDatabases::compute_abstract_state_indices(
+    const TNFState &original_state, vector<int> &state_indices) const {
+    if (bank) {
+        bank->compute_abstract_state_indices(original_state, state_indices);
+    } else {
+        state_indices.clear();
+        for (const PatternDatabase &pdb : pdbs) {
+            state_indices.push_back(pdb.get_abstract_state_index(original_state));
+        }
+    }
+}
+
+int CanonicalPatternDatabases::compute_heuristic_of_abstract_states(
+    const vector<int> &state_indices) {
+    ++num_lookups;
+    if (is_abstract_dead_end(state_indices)) {
+        return numeric_limits<int>::max();
+    }
+    if (!cache) {
+        return compute_heuristic_of_indices(state_indices);
+    }
+    int h;
+    if (!cache->lookup(state_indices, h)) {
+        h = compute_heuristic_of_indices(state_indices);
+        cache->insert(state_indices, h);
+    }
+    return h;
+}
+
+// How often (in lookups) we reorder the dead-end checks by their prune rate.
+static const long long DEAD_END_ORDER_INTERVAL = 4096;
+
+bool CanonicalPatternDatabases::is_abstract_dead_end(const vector<int> &state_indices) {
+    /*
+      The bitmaps are much smaller than the distance tables, so most
+      dead ends are detected without reading any table entry.
+    */
+    if (num_lookups % DEAD_END_ORDER_INTERVAL == 0) {
+        sort_dead_end_checks();
+    }
+    for (int pdb_index : dead_end_order) {
+        ++num_dead_end_checks[pdb_index];
+        if (pdbs[pdb_index].is_dead_end_index(state_indices[pdb_index])) {
+            ++num_dead_end_prunes[pdb_index];
+            return true;
+        }
+    }
+    return false;
+}
+
+void CanonicalPatternDatabases::sort_dead_end_checks() {
+    // Check the PDBs with the highest fraction of pruned states first.
+    stable_sort(dead_end_order.begin(), dead_end_order.end(),
+                [this](int pdb1, int pdb2) {
+                    return num_dead_end_prunes[pdb1] * max(1LL, num_dead_end_checks[pdb2]) >
+                           num_dead_end_prunes[pdb2] * max(1LL, num_dead_end_checks[pdb1]);
+                });
+}
+
+int CanonicalPatternDatabases::compute_heuristic_of_indices(
+    const vector<int> &state_indices) {
     /*
       To avoid the overhead of looking up the heuristic value of a PDB multiple
       times (if that PDB occurs in multiple cliques), we pre-compute all
       heuristic values. Use heuristic_values[i] for the heuristic value of
       pdbs[i] in your code below.
     */
-    vector<int> heuristic_values;
-    heuristic_values.reserve(pdbs.size());
-    for (const PatternDatabase &pdb : pdbs) {
-        heuristic_values.push_back(pdb.lookup_distance(original_state));
-        /*
-          special case: if one of the PDBs detects unsolvability, we can
-          return infinity right away. Otherwise, we would have to deal with
-          integer overflows when adding numbers below.
-        */
-        if (heuristic_values.back() == numeric_limits<int>::max()) {
-            return numeric_limits<int>::max();
+    if (bank) {
+        // compute_max_additive_sum below handles infinite values.
+        bank->lookup_distances(state_indices, heuristic_values);
+    } else {
+        heuristic_values.clear();
+        for (size_t i = 0; i < pdbs.size(); ++i) {
+            heuristic_values.push_back(pdbs[i].lookup_distance_of_index(state_indices[i]));
+            /*
+              special case: if one of the PDBs detects unsolvability, we can
+              return infinity right away. Otherwise, we would have to deal with
+              integer overflows when adding numbers below.
+            */
+            if (heuristic_values.back() == numeric_limits<int>::max()) {
+                return numeric_limits<int>::max();
+            }
         }
     }
 
@@ -104,23 +356,63 @@ int CanonicalPatternDatabases::compute_heuristic(const TNFState &original_state)
       Use maximal_additive_sets and heuristic_values to compute the value
       of the canonical heuristic.
     */
-    int h = 0;
+    num_evaluated_cliques += maximal_additive_sets.size();
+    return compute_max_additive_sum(maximal_additive_sets, heuristic_values);
+}
 
-    for(unsigned int clique = 0; clique < maximal_additive_sets.size(); clique++){ // iterates through each clique in maximal_additive_sets
-        int sum = 0;
-        for(auto pdb : maximal_additive_sets[clique]){ // for each pdb in the clique, add its heuristic value to sum
-            sum += heuristic_values[pdb];
-        }
-        if(sum>h) // selects the greatest value of sum as the heuristic value
-            h = sum;
+vector<Pattern> CanonicalPatternDatabases::get_patterns() const {
+    vector<Pattern> patterns;
+    patterns.reserve(pdbs.size());
+    for (const PatternDatabase &pdb : pdbs) {
+        patterns.push_back(pdb.get_pattern());
     }
-
-    return h;
+    return patterns;
 }
 
+size_t CanonicalPatternDatabases::get_table_bytes() const {
+    if (bank) {
+        size_t table_bytes = bank->get_memory_usage_in_bytes();
+        for (const PatternDatabase &pdb : pdbs) {
+            table_bytes += pdb.get_dead_end_memory_usage_in_bytes();
+        }
+        return table_bytes;
+    }
+    size_t table_bytes = 0;
+    for (const PatternDatabase &pdb : pdbs) {
+        table_bytes += pdb.get_statistics().table_bytes;
+    }
+    return table_bytes;
+}
 
+void CanonicalPatternDatabases::print_statistics() const {
+    for (const PatternDatabase &pdb : pdbs) {
+        pdb.print_statistics();
+    }
+    g_log << "Canonical PDBs statistics: pdbs=" << pdbs.size()
+          << " cliques=" << maximal_additive_sets.size()
+          << " redundant_pdbs=" << num_redundant_pdbs
+          << " redundant_table_bytes=" << redundant_table_bytes
+          << " bank=" << (bank ? "yes" : "no")
+          << " dead_end_bitmaps=" << dead_end_order.size()
+          << " table_bytes=" << get_table_bytes()
+          << " pdb_construction_time=" << pdb_construction_time << "s"
+          << " compatibility_graph_time=" << compatibility_graph_time << "s"
+          << " clique_time=" << clique_time << "s"
+          << endl;
+}
 
-
-
-
+void CanonicalPatternDatabases::print_lookup_statistics() const {
+    double average_cliques = num_lookups ?
+        static_cast<double>(num_evaluated_cliques) / num_lookups : 0;
+    long long num_prunes = 0;
+    for (long long prunes : num_dead_end_prunes) {
+        num_prunes += prunes;
+    }
+    g_log << "Canonical PDBs lookups: lookups=" << num_lookups
+          << " dead_end_prunes=" << num_prunes
+          << " average_evaluated_cliques=" << average_cliques << endl;
+    if (cache) {
+        cache->print_statistics();
+    }
+}
 }
@@ -1,19 +1,124 @@
 #ifndef PLANOPT_HEURISTICS_CANONICAL_PDBS_H
 #define PLANOPT_HEURISTICS_CANONICAL_PDBS_H
 
+#include "heuristic_cache.h"
 #include "pdb.h"
+#include "pdb_bank.h"
 
+#include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace planopt_heuristics {
 
+// True if the operator changes the value of a variable in the pattern.
+extern bool affects_pattern(const TNFOperator &op, const Pattern &pattern);
+
+extern std::vector<std::vector<int>> build_compatibility_graph(
+    const std::vector<Pattern> &patterns, const TNFTask &task);
+
+/*
+  Return the maximum over all given sets of the sum of their heuristic values
+  or infinity if one of the values is infinite.
+*/
+extern int compute_max_additive_sum(
+    const std::vector<std::vector<int>> &maximal_additive_sets,
+    const std::vector<int> &heuristic_values);
+
 class CanonicalPatternDatabases {
+    /*
+      A PDB whose abstract state changes when an operator is applied, with
+      the positions of the changed variables in its pattern.
+    */
+    struct RankUpdate {
+        int pdb_index;
+        std::vector<int> pattern_positions;
+    };
+
+    // Sorted by the number of abstract states.
     std::vector<PatternDatabase> pdbs;
+    // The rank updates of all PDBs for each operator of the task.
+    std::vector<std::vector<RankUpdate>> rank_updates;
     std::vector<std::vector<int>> maximal_additive_sets;
+    // Holds the distance tables of all PDBs if they all have full tables.
+    std::unique_ptr<PDBBank> bank;
+    // Maps the abstract state ranks of all PDBs to the heuristic value.
+    std::unique_ptr<HeuristicCache> cache;
+    std::vector<int> abstract_state_indices;
+    std::vector<int> heuristic_values;
+    /*
+      Indices of the PDBs with a dead-end bitmap, in the order in which we
+      check them, with the number of checks and prunes of each PDB.
+    */
+    std::vector<int> dead_end_order;
+    std::vector<long long> num_dead_end_checks;
+    std::vector<long long> num_dead_end_prunes;
+
+    // PDBs removed by remove_redundant_pdbs and the size of their tables.
+    int num_redundant_pdbs;
+    std::size_t redundant_table_bytes;
+    double pdb_construction_time;
+    double compatibility_graph_time;
+    double clique_time;
+    long long num_lookups;
+    long long num_evaluated_cliques;
+
+    bool is_dominated_in_all_cliques(int pdb_index, int dominating_pdb_index) const;
+    void remove_redundant_pdbs(std::vector<std::vector<int>> &compatibility_graph);
+    bool is_abstract_dead_end(const std::vector<int> &state_indices);
+    void sort_dead_end_checks();
+    int compute_heuristic_of_indices(const std::vector<int> &state_indices);
+    void initialize(const TNFTask &task, const PDBSettings &settings, int cache_size);
 public:
-    CanonicalPatternDatabases(const TNFTask &task, const std::vector<Pattern> &patterns);
+    CanonicalPatternDatabases(const TNFTask &task, const std::vector<Pattern> &patterns,
+                              const PDBSettings &settings = PDBSettings(),
+                              int cache_size = 0);
+    /*
+      Take over PDBs that the caller already built with the given settings,
+      e.g., while generating their patterns.
+    */
+    CanonicalPatternDatabases(const TNFTask &task, std::vector<PatternDatabase> &&pdbs,
+                              const PDBSettings &settings = PDBSettings(),
+                              int cache_size = 0);
 
     int compute_heuristic(const TNFState &original_state);
+
+    /*
+      The following functions split compute_heuristic into computing the
+      ranks of the abstract states in all PDBs and computing the heuristic
+      value of these ranks. This lets callers store the ranks of a state
+      and compute the ranks of its successors incrementally.
+    */
+    void compute_abstract_state_indices(
+        const TNFState &original_state, std::vector<int> &state_indices) const;
+    int compute_heuristic_of_abstract_states(const std::vector<int> &state_indices);
+    /*
+      Turn the ranks of parent_state into the ranks of state, which is
+      reached from parent_state by the operator with the given index. Only
+      the ranks of PDBs whose pattern contains a variable changed by the
+      operator are touched. The states can be of any type that returns the
+      value of a variable with operator[].
+    */
+    template<typename State>
+    void update_abstract_state_indices(
+        const State &parent_state, int op_id, const State &state,
+        std::vector<int> &state_indices) const {
+        for (const RankUpdate &update : rank_updates[op_id]) {
+            state_indices[update.pdb_index] +=
+                pdbs[update.pdb_index].get_projection().get_rank_difference(
+                    update.pattern_positions, parent_state, state);
+        }
+    }
+
+    std::vector<Pattern> get_patterns() const;
+    std::size_t get_table_bytes() const;
+
+    long long get_num_lookups() const {
+        return num_lookups;
+    }
+    // Print the statistics of all PDBs and of the construction.
+    void print_statistics() const;
+    void print_lookup_statistics() const;
 };
 }
 
@@ -0,0 +1,41 @@
+#include "canonical_pdbs_evaluator.h"
+
+using namespace std;
+
+namespace planopt_heuristics {
+CanonicalPDBsEvaluator::CanonicalPDBsEvaluator(bool incremental)
+    : incremental(incremental) {
+}
+
+void CanonicalPDBsEvaluator::notify_state_transition(
+    const CanonicalPatternDatabases &cpdbs, const GlobalState &parent_state,
+    OperatorID op_id, const GlobalState &state) {
+    const vector<int> &parent_indices = abstract_state_indices[parent_state];
+    vector<int> &indices = abstract_state_indices[state];
+    if (!parent_indices.empty() && indices.empty()) {
+        indices = parent_indices;
+        cpdbs.update_abstract_state_indices(parent_state, op_id.get_index(), state, indices);
+    }
+}
+
+int CanonicalPDBsEvaluator::compute_heuristic(
+    CanonicalPatternDatabases &cpdbs, const GlobalState &global_state) {
+    int h;
+    if (incremental) {
+        vector<int> &indices = abstract_state_indices[global_state];
+        if (indices.empty()) {
+            cpdbs.compute_abstract_state_indices(global_state.get_values(), indices);
+        }
+        h = cpdbs.compute_heuristic_of_abstract_states(indices);
+    } else {
+        TNFState state = global_state.get_values();
+        h = cpdbs.compute_heuristic(state);
+    }
+    long long num_lookups = cpdbs.get_num_lookups();
+    if (num_lookups >= (1 << 16) && (num_lookups & (num_lookups - 1)) == 0) {
+        // Report at powers of two, so a run killed by a time limit still logs.
+        cpdbs.print_lookup_statistics();
+    }
+    return h;
+}
+}
@@ -0,0 +1,41 @@
+#ifndef PLANOPT_HEURISTICS_CANONICAL_PDBS_EVALUATOR_H
+#define PLANOPT_HEURISTICS_CANONICAL_PDBS_EVALUATOR_H
+
+#include "canonical_pdbs.h"
+
+#include "../global_state.h"
+#include "../operator_id.h"
+#include "../per_state_information.h"
+
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  Evaluates canonical PDBs for the heuristics built on them. In incremental
+  mode, we store the abstract state ranks of every reached state and
+  update the ranks of the PDBs affected by the applied operator for each
+  successor. Heuristics that use incremental mode have to register as
+  path-dependent evaluators and forward notify_state_transition.
+*/
+class CanonicalPDBsEvaluator {
+    bool incremental;
+    PerStateInformation<std::vector<int>> abstract_state_indices;
+public:
+    explicit CanonicalPDBsEvaluator(bool incremental);
+
+    bool is_incremental() const {
+        return incremental;
+    }
+    void notify_state_transition(
+        const CanonicalPatternDatabases &cpdbs, const GlobalState &parent_state,
+        OperatorID op_id, const GlobalState &state);
+    /*
+      Return the canonical heuristic value of the state (infinity for
+      dead ends) and log lookup statistics whenever the number of lookups
+      reaches a power of two.
+    */
+    int compute_heuristic(CanonicalPatternDatabases &cpdbs, const GlobalState &state);
+};
+}
+
+#endif
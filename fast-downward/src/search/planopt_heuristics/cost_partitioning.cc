@@ -0,0 +1,26 @@
+#include "cost_partitioning.h"
+
+#include <cassert>
+
+using namespace std;
+
+namespace planopt_heuristics {
+vector<int> get_operator_costs(const TNFTask &task) {
+    vector<int> costs;
+    costs.reserve(task.operators.size());
+    for (const TNFOperator &op : task.operators) {
+        costs.push_back(op.cost);
+    }
+    return costs;
+}
+
+TNFTask create_task_with_costs(const TNFTask &task, const vector<int> &costs) {
+    assert(costs.size() == task.operators.size());
+    TNFTask result = task;
+    for (size_t op_id = 0; op_id < costs.size(); ++op_id) {
+        assert(costs[op_id] >= 0);
+        result.operators[op_id].cost = costs[op_id];
+    }
+    return result;
+}
+}
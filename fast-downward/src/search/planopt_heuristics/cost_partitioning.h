@@ -0,0 +1,18 @@
+#ifndef PLANOPT_HEURISTICS_COST_PARTITIONING_H
+#define PLANOPT_HEURISTICS_COST_PARTITIONING_H
+
+#include "tnf_task.h"
+
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  Helpers for heuristics that build PDBs for the same task under several
+  cost functions. A cost function assigns a cost to each operator of the
+  task (indexed like task.operators).
+*/
+extern std::vector<int> get_operator_costs(const TNFTask &task);
+extern TNFTask create_task_with_costs(const TNFTask &task, const std::vector<int> &costs);
+}
+
+#endif
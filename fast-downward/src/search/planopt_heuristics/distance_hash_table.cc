@@ -0,0 +1,73 @@
+#include "distance_hash_table.h"
+
+#include <cassert>
+
+using namespace std;
+
+const static int EMPTY = -1;
+
+namespace planopt_heuristics {
+static size_t hash_rank(int rank) {
+    // Multiplicative hashing spreads consecutive ranks over the table.
+    return static_cast<size_t>(static_cast<unsigned int>(rank) * 2654435761u);
+}
+
+DistanceHashTable::DistanceHashTable()
+    : keys(16, EMPTY),
+      values(16, 0),
+      num_entries(0) {
+}
+
+size_t DistanceHashTable::find_slot(int rank) const {
+    // The capacity is always a power of two.
+    size_t mask = keys.size() - 1;
+    size_t slot = hash_rank(rank) & mask;
+    while (keys[slot] != EMPTY && keys[slot] != rank) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void DistanceHashTable::grow() {
+    vector<int> old_keys = move(keys);
+    vector<int> old_values = move(values);
+    keys.assign(old_keys.size() * 2, EMPTY);
+    values.assign(old_values.size() * 2, 0);
+    for (size_t i = 0; i < old_keys.size(); ++i) {
+        if (old_keys[i] != EMPTY) {
+            size_t slot = find_slot(old_keys[i]);
+            keys[slot] = old_keys[i];
+            values[slot] = old_values[i];
+        }
+    }
+}
+
+void DistanceHashTable::insert(int rank, int distance) {
+    assert(rank != EMPTY);
+    if (2 * (num_entries + 1) > keys.size()) {
+        grow();
+    }
+    size_t slot = find_slot(rank);
+    if (keys[slot] == EMPTY) {
+        keys[slot] = rank;
+        ++num_entries;
+    }
+    values[slot] = distance;
+}
+
+bool DistanceHashTable::contains(int rank) const {
+    return keys[find_slot(rank)] != EMPTY;
+}
+
+int DistanceHashTable::lookup(int rank, int default_distance) const {
+    size_t slot = find_slot(rank);
+    if (keys[slot] == EMPTY) {
+        return default_distance;
+    }
+    return values[slot];
+}
+
+size_t DistanceHashTable::get_memory_usage_in_bytes() const {
+    return (keys.capacity() + values.capacity()) * sizeof(int);
+}
+}
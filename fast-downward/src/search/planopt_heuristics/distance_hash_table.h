@@ -0,0 +1,41 @@
+#ifndef PLANOPT_HEURISTICS_DISTANCE_HASH_TABLE_H
+#define PLANOPT_HEURISTICS_DISTANCE_HASH_TABLE_H
+
+#include <cstddef>
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  Maps the ranks of abstract states to goal distances. Pattern databases
+  that only know the distances of some abstract states use this instead of
+  a full table. Entries are stored in a single array with open addressing
+  and linear probing, so an entry only costs two ints (plus the free slots
+  needed to keep the load factor below 1/2).
+
+  Entries cannot be removed.
+*/
+class DistanceHashTable {
+    // keys[i] is the rank stored in slot i or -1; values[i] is its distance.
+    std::vector<int> keys;
+    std::vector<int> values;
+    std::size_t num_entries;
+
+    std::size_t find_slot(int rank) const;
+    void grow();
+public:
+    DistanceHashTable();
+
+    void insert(int rank, int distance);
+    bool contains(int rank) const;
+    // Return the distance of the given rank or default_distance if unknown.
+    int lookup(int rank, int default_distance) const;
+
+    std::size_t size() const {
+        return num_entries;
+    }
+
+    std::size_t get_memory_usage_in_bytes() const;
+};
+}
+
+#endif
@@ -0,0 +1,95 @@
+#include "h_benchmark.h"
+
+#include "pdb_benchmarks.h"
+#include "pdb_test.h"
+#include "tnf_task.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include "../utils/system.h"
+#include "../utils/timer.h"
+
+#include <iostream>
+
+using namespace std;
+
+namespace planopt_heuristics {
+BenchmarkHeuristic::BenchmarkHeuristic(const options::Options &options)
+    : Heuristic(options) {
+    BenchmarkSettings settings;
+    settings.repetitions = options.get<int>("repetitions");
+    settings.num_lookups = options.get<int>("lookups");
+    settings.size_bound = options.get<int>("size_bound");
+
+    utils::Timer tnf_timer;
+    for (int i = 0; i < settings.repetitions - 1; ++i) {
+        create_tnf_task(task_proxy);
+    }
+    TNFTask task = create_tnf_task(task_proxy);
+    report_benchmark(cout, "input", "create_tnf_task", settings.repetitions,
+                     tnf_timer(),
+                     "\"variables\": " + to_string(task.variable_domains.size()) +
+                     ", \"operators\": " + to_string(task.operators.size()));
+
+    vector<Pattern> patterns = options.get_list<Pattern>("patterns");
+    if (patterns.empty()) {
+        for (FactProxy goal : task_proxy.get_goals()) {
+            patterns.push_back({goal.get_variable().get_id()});
+        }
+    }
+    run_pdb_benchmarks("input", task, patterns, settings, cout);
+
+    if (options.get<bool>("synthetic")) {
+        run_synthetic_pdb_benchmarks(settings, cout);
+    }
+
+    int num_test_tasks = options.get<int>("test_tasks");
+    if (num_test_tasks > 0 && test_pattern_databases(num_test_tasks, 2019, cout) > 0) {
+        cerr << "PDB engines disagree with the reference search" << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+    }
+}
+
+int BenchmarkHeuristic::compute_heuristic(const GlobalState &) {
+    return 0;
+}
+
+static Heuristic *_parse(OptionParser &parser) {
+    Heuristic::add_options_to_parser(parser);
+    parser.add_list_option<vector<int>>(
+        "patterns",
+        "patterns to benchmark on the input task (default: goal singletons)",
+        "[]");
+    parser.add_option<int>(
+        "repetitions",
+        "number of times each construction is repeated",
+        "5");
+    parser.add_option<int>(
+        "lookups",
+        "number of random states used to measure lookup throughput",
+        "100000");
+    parser.add_option<int>(
+        "size_bound",
+        "size bound for the hill climbing benchmark",
+        "10000");
+    parser.add_option<bool>(
+        "synthetic",
+        "also run the benchmarks on the truck task and random tasks",
+        "true");
+    parser.add_option<int>(
+        "test_tasks",
+        "number of random tasks on which all PDB engines and storage modes "
+        "are compared to the reference search (see test_pattern_databases); "
+        "the planner exits with an error if they disagree",
+        "0");
+    Options opts = parser.parse();
+    if (parser.dry_run())
+        return nullptr;
+    else
+        return new BenchmarkHeuristic(opts);
+}
+
+static Plugin<Heuristic> _plugin("planopt_benchmark", _parse);
+
+}
@@ -0,0 +1,20 @@
+#ifndef PLANOPT_HEURISTICS_H_BENCHMARK_H
+#define PLANOPT_HEURISTICS_H_BENCHMARK_H
+
+#include "../heuristic.h"
+
+namespace planopt_heuristics {
+/*
+  Not a real heuristic: the constructor runs the PDB microbenchmarks on the
+  given task (and optionally on synthetic tasks) and writes the results to
+  stdout as JSON lines. Use it with bound=0 to skip the search, e.g.
+    astar(planopt_benchmark(patterns=[[0, 1], [2]]), bound=0)
+*/
+class BenchmarkHeuristic : public Heuristic {
+protected:
+    virtual int compute_heuristic(const GlobalState &state) override;
+public:
+    explicit BenchmarkHeuristic(const options::Options &options);
+};
+}
+#endif
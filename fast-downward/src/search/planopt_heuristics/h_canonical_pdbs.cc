@@ -8,13 +8,30 @@ using namespace std;
 namespace planopt_heuristics {
 CanonicalPDBsHeuristic::CanonicalPDBsHeuristic(const options::Options &options)
     : Heuristic(options),
-      pdbs(create_tnf_task(task_proxy), options.get_list<vector<int>>("patterns")) {
+      pdbs(create_tnf_task(task_proxy), options.get_list<vector<int>>("patterns"),
+           get_pdb_settings_from_options(options), options.get<int>("cache_size")),
+      report(options, "planopt_cpdbs"),
+      evaluator(options.get<bool>("incremental")) {
+    pdbs.print_statistics();
+    report.report_construction(
+        pdbs.get_patterns(), construction_timer(), pdbs.get_table_bytes(),
+        pdbs.compute_heuristic(task_proxy.get_initial_state().get_values()));
 }
 
-int CanonicalPDBsHeuristic::compute_heuristic(const GlobalState &global_state) {
-    TNFState state = global_state.get_values();
+void CanonicalPDBsHeuristic::get_path_dependent_evaluators(set<Evaluator *> &evals) {
+    if (evaluator.is_incremental()) {
+        evals.insert(this);
+    }
+}
 
-    int h = pdbs.compute_heuristic(state);
+void CanonicalPDBsHeuristic::notify_state_transition(
+    const GlobalState &parent_state, OperatorID op_id, const GlobalState &state) {
+    evaluator.notify_state_transition(pdbs, parent_state, op_id, state);
+}
+
+int CanonicalPDBsHeuristic::compute_heuristic(const GlobalState &global_state) {
+    int h = evaluator.compute_heuristic(pdbs, global_state);
+    report.report_evaluation(h);
     if (h == numeric_limits<int>::max()) {
         return DEAD_END;
     } else {
@@ -25,7 +42,19 @@ int CanonicalPDBsHeuristic::compute_heuristic(const GlobalState &global_state) {
 static Heuristic *_parse(OptionParser &parser) {
     Heuristic::add_options_to_parser(parser);
     parser.add_list_option<vector<int>>("patterns");
+    add_pdb_options_to_parser(parser);
+    add_heuristic_cache_options_to_parser(parser);
+    add_incremental_evaluation_option_to_parser(parser);
+    add_statistics_report_options_to_parser(parser);
     Options opts = parser.parse();
+    if (get_pdb_settings_from_options(opts).max_domain_size < 2)
+        parser.error("max_domain_size must be at least 2");
+    if (get_pdb_settings_from_options(opts).compression == PDBCompression::MOD3)
+        parser.error("mod3 compression is only supported by planopt_pdb");
+    if (get_pdb_settings_from_options(opts).num_threads < 1)
+        parser.error("threads must be at least 1");
+    if (get_pdb_settings_from_options(opts).symbolic)
+        parser.error("symbolic PDBs are only supported by planopt_pdb");
     if (parser.dry_run())
         return nullptr;
     else
@@ -0,0 +1,94 @@
+#include "h_cegar_pdbs.h"
+
+#include "pattern_cegar.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+using namespace std;
+
+namespace planopt_heuristics {
+static CanonicalPatternDatabases create_cpdbs_by_cegar(
+    const TaskProxy &task_proxy, const options::Options &options) {
+    TNFTask task = create_tnf_task(task_proxy);
+    vector<int> goal_variables;
+    for (FactProxy goal : task_proxy.get_goals()) {
+        goal_variables.push_back(goal.get_variable().get_id());
+    }
+    int max_time = options.get<int>("max_time");
+    PatternCEGAR cegar(
+        task, goal_variables, options.get<int>("max_pdb_size"),
+        options.get<int>("max_collection_size"),
+        max_time == numeric_limits<int>::max() ?
+        numeric_limits<double>::infinity() : max_time);
+    cegar.run();
+    // PatternCEGAR builds its PDBs with the default settings.
+    return CanonicalPatternDatabases(
+        task, cegar.extract_pdbs(), PDBSettings(), options.get<int>("cache_size"));
+}
+
+CEGARPDBsHeuristic::CEGARPDBsHeuristic(const options::Options &options)
+    : Heuristic(options),
+      cpdbs(create_cpdbs_by_cegar(task_proxy, options)),
+      report(options, "planopt_cegar_pdbs"),
+      evaluator(options.get<bool>("incremental")) {
+    cpdbs.print_statistics();
+    report.report_construction(
+        cpdbs.get_patterns(), construction_timer(), cpdbs.get_table_bytes(),
+        cpdbs.compute_heuristic(task_proxy.get_initial_state().get_values()));
+}
+
+void CEGARPDBsHeuristic::get_path_dependent_evaluators(set<Evaluator *> &evals) {
+    if (evaluator.is_incremental()) {
+        evals.insert(this);
+    }
+}
+
+void CEGARPDBsHeuristic::notify_state_transition(
+    const GlobalState &parent_state, OperatorID op_id, const GlobalState &state) {
+    evaluator.notify_state_transition(cpdbs, parent_state, op_id, state);
+}
+
+int CEGARPDBsHeuristic::compute_heuristic(const GlobalState &global_state) {
+    int h = evaluator.compute_heuristic(cpdbs, global_state);
+    report.report_evaluation(h);
+    if (h == numeric_limits<int>::max()) {
+        return DEAD_END;
+    } else {
+        return h;
+    }
+}
+
+static Heuristic *_parse(OptionParser &parser) {
+    Heuristic::add_options_to_parser(parser);
+    parser.add_option<int>(
+        "max_pdb_size",
+        "maximum number of abstract states of a single pattern",
+        "2000000");
+    parser.add_option<int>(
+        "max_collection_size",
+        "maximum total number of abstract states of the collection",
+        "20000000");
+    parser.add_option<int>(
+        "max_time",
+        "maximum time in seconds for refining the collection",
+        "infinity");
+    add_heuristic_cache_options_to_parser(parser);
+    add_incremental_evaluation_option_to_parser(parser);
+    add_statistics_report_options_to_parser(parser);
+    Options opts = parser.parse();
+    if (opts.get<int>("max_pdb_size") < 1)
+        parser.error("max_pdb_size must be at least 1");
+    if (opts.get<int>("max_collection_size") < 1)
+        parser.error("max_collection_size must be at least 1");
+    if (opts.get<int>("max_time") < 0)
+        parser.error("max_time must be non-negative");
+    if (parser.dry_run())
+        return nullptr;
+    else
+        return new CEGARPDBsHeuristic(opts);
+}
+
+static Plugin<Heuristic> _plugin("planopt_cegar_pdbs", _parse);
+
+}
@@ -0,0 +1,30 @@
+#ifndef PLANOPT_HEURISTICS_H_CEGAR_PDBS_H
+#define PLANOPT_HEURISTICS_H_CEGAR_PDBS_H
+
+#include "canonical_pdbs.h"
+#include "canonical_pdbs_evaluator.h"
+#include "statistics_report.h"
+
+#include "../heuristic.h"
+
+#include "../utils/timer.h"
+
+namespace planopt_heuristics {
+class CEGARPDBsHeuristic : public Heuristic {
+    // Declared first, so it measures the construction of all other members.
+    utils::Timer construction_timer;
+    CanonicalPatternDatabases cpdbs;
+    StatisticsReport report;
+    CanonicalPDBsEvaluator evaluator;
+protected:
+    virtual int compute_heuristic(const GlobalState &state) override;
+public:
+    explicit CEGARPDBsHeuristic(const options::Options &options);
+
+    virtual void get_path_dependent_evaluators(std::set<Evaluator *> &evals) override;
+    virtual void notify_state_transition(
+        const GlobalState &parent_state, OperatorID op_id,
+        const GlobalState &state) override;
+};
+}
+#endif
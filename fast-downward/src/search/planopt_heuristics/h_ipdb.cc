@@ -9,14 +9,17 @@
 #include "../task_utils/sampling.h"
 #include "../task_utils/task_properties.h"
 #include "../utils/logging.h"
+#include "../utils/memory.h"
 #include "../utils/rng.h"
+#include "../utils/timer.h"
+
+#include <algorithm>
+#include <cstdlib>
 
 using namespace std;
 
 namespace planopt_heuristics {
-CanonicalPatternDatabases create_cpdbs_by_hillclimbing(const TaskProxy &task_proxy, int size_bound) {
-    TNFTask task = create_tnf_task(task_proxy);
-
+static vector<TNFState> sample_states(const TaskProxy &task_proxy, const TNFTask &task) {
     vector<Pattern> sampling_collection;
     for (FactProxy goal : task_proxy.get_goals()) {
         sampling_collection.push_back({goal.get_variable().get_id()});
@@ -28,6 +31,7 @@ CanonicalPatternDatabases create_cpdbs_by_hillclimbing(const TaskProxy &task_pro
     int average_operator_cost = task_properties::get_average_operator_cost(task_proxy);
 
     g_log << "Sampling states for iPDB hillclimbing" << endl;
+    utils::Timer sampling_timer;
     vector<State> samples = sampling::sample_states_with_random_walks(
         task_proxy, *g_successor_generator, 1000, init_h,
         average_operator_cost,
@@ -40,21 +44,154 @@ CanonicalPatternDatabases create_cpdbs_by_hillclimbing(const TaskProxy &task_pro
     for (const State &sample : samples) {
         tnf_samples.push_back(sample.get_values());
     }
-    g_log << "Finished sampling states for iPDB hillclimbing" << endl;
+    g_log << "Finished sampling states for iPDB hillclimbing: "
+          << tnf_samples.size() << " samples in " << sampling_timer << endl;
+    return tnf_samples;
+}
+
+static size_t get_memory_bound_in_bytes(const options::Options &options) {
+    int memory_bound = options.get<int>("memory_bound");
+    if (memory_bound == numeric_limits<int>::max())
+        return numeric_limits<size_t>::max();
+    return static_cast<size_t>(memory_bound) * 1024;
+}
+
+static double get_max_climbing_time(const options::Options &options) {
+    int max_climbing_time = options.get<int>("max_climbing_time");
+    if (max_climbing_time == numeric_limits<int>::max())
+        return numeric_limits<double>::infinity();
+    return max_climbing_time;
+}
 
-    vector<Pattern> collection = HillClimber(task, size_bound, move(tnf_samples)).run();
-    return CanonicalPatternDatabases(task, collection);
+/*
+  Heuristics whose background thread may still run. Only the main thread
+  registers and unregisters them.
+*/
+static vector<IPDBHeuristic *> climbing_heuristics;
+
+static void finish_all_climbing() {
+    // finish_climbing unregisters the heuristic.
+    while (!climbing_heuristics.empty()) {
+        climbing_heuristics.back()->finish_climbing();
+    }
 }
 
 IPDBHeuristic::IPDBHeuristic(const options::Options &options)
     : Heuristic(options),
-      cpdbs(create_cpdbs_by_hillclimbing(task_proxy, options.get<int>("size_bound"))) {
+      report(options, "planopt_ipdb"),
+      evaluator(options.get<bool>("incremental")),
+      stop_climbing(false),
+      climbing_finished(false),
+      climbing_time(0) {
+    TNFTask task = create_tnf_task(task_proxy);
+    vector<TNFState> samples = sample_states(task_proxy, task);
+    int size_bound = options.get<int>("size_bound");
+    int cache_size = options.get<int>("cache_size");
+    size_t memory_bound = get_memory_bound_in_bytes(options);
+    bool maximize_improvement_per_byte = options.get<bool>("improvement_per_byte");
+    PDBSettings settings;
+    settings.max_domain_size = options.get<int>("max_domain_size");
+
+    if (options.get<bool>("anytime")) {
+        // This is the initial collection of the hill climber.
+        vector<Pattern> singletons;
+        for (size_t var = 0; var < task.variable_domains.size(); ++var) {
+            if (task.is_relevant(var)) {
+                singletons.push_back({static_cast<int>(var)});
+            }
+        }
+        cpdbs = make_shared<CanonicalPatternDatabases>(task, singletons, settings, cache_size);
+        climbing_task = move(task);
+        climber = utils::make_unique_ptr<HillClimber>(
+            climbing_task, size_bound, move(samples), settings, memory_bound,
+            maximize_improvement_per_byte, false);
+        if (climbing_heuristics.empty()) {
+            atexit(finish_all_climbing);
+        }
+        climbing_heuristics.push_back(this);
+        climbing_thread = thread(
+            &IPDBHeuristic::climb_in_background, this, settings, cache_size,
+            get_max_climbing_time(options));
+    } else {
+        vector<Pattern> collection = HillClimber(
+            task, size_bound, move(samples), settings, memory_bound,
+            maximize_improvement_per_byte).run();
+        cpdbs = make_shared<CanonicalPatternDatabases>(task, collection, settings, cache_size);
+    }
+    cpdbs->print_statistics();
+    report.report_construction(
+        cpdbs->get_patterns(), construction_timer(), cpdbs->get_table_bytes(),
+        cpdbs->compute_heuristic(task_proxy.get_initial_state().get_values()));
 }
 
-int IPDBHeuristic::compute_heuristic(const GlobalState &global_state) {
-    TNFState state = global_state.get_values();
+IPDBHeuristic::~IPDBHeuristic() {
+    finish_climbing();
+}
 
-    int h = cpdbs.compute_heuristic(state);
+void IPDBHeuristic::finish_climbing() {
+    if (!climbing_thread.joinable())
+        return;
+    stop_climbing = true;
+    climbing_thread.join();
+    climbing_heuristics.erase(
+        find(climbing_heuristics.begin(), climbing_heuristics.end(), this));
+    climber->print_statistics(climbing_time);
+    climber = nullptr;
+}
+
+void IPDBHeuristic::climb_in_background(
+    PDBSettings settings, int cache_size, double max_climbing_time) {
+    utils::Timer climbing_timer;
+    climber->run(
+        max_climbing_time,
+        [this]() {return stop_climbing.load(); },
+        [&](vector<PatternDatabase> &&pdbs) {
+            /*
+              Each collection extends the previous one by a pattern and
+              every additive set of the previous collection stays additive,
+              so the newest PDBs dominate all earlier ones and replace them.
+            */
+            if (!stop_climbing) {
+                atomic_store(&published_cpdbs, make_shared<CanonicalPatternDatabases>(
+                                 climbing_task, move(pdbs), settings, cache_size));
+            }
+        });
+    climbing_time = climbing_timer();
+    climbing_finished = true;
+}
+
+void IPDBHeuristic::switch_to_published_cpdbs() {
+    shared_ptr<CanonicalPatternDatabases> newest = atomic_exchange(
+        &published_cpdbs, shared_ptr<CanonicalPatternDatabases>());
+    if (newest) {
+        cpdbs = move(newest);
+        g_log << "Switched to iPDB collection with " << cpdbs->get_patterns().size()
+              << " patterns and " << cpdbs->get_table_bytes() << " table bytes" << endl;
+    }
+}
+
+void IPDBHeuristic::get_path_dependent_evaluators(set<Evaluator *> &evals) {
+    if (evaluator.is_incremental()) {
+        evals.insert(this);
+    }
+}
+
+void IPDBHeuristic::notify_state_transition(
+    const GlobalState &parent_state, OperatorID op_id, const GlobalState &state) {
+    evaluator.notify_state_transition(*cpdbs, parent_state, op_id, state);
+}
+
+int IPDBHeuristic::compute_heuristic(const GlobalState &global_state) {
+    if (climbing_thread.joinable()) {
+        switch_to_published_cpdbs();
+        if (climbing_finished) {
+            finish_climbing();
+            // The thread may have published a collection after our last check.
+            switch_to_published_cpdbs();
+        }
+    }
+    int h = evaluator.compute_heuristic(*cpdbs, global_state);
+    report.report_evaluation(h);
     if (h == numeric_limits<int>::max()) {
         return DEAD_END;
     } else {
@@ -65,7 +202,43 @@ int IPDBHeuristic::compute_heuristic(const GlobalState &global_state) {
 static Heuristic *_parse(OptionParser &parser) {
     Heuristic::add_options_to_parser(parser);
     parser.add_option<int>("size_bound");
+    parser.add_option<int>(
+        "max_domain_size",
+        "merge the values of pattern variables with larger domains into this "
+        "many abstract values; pattern sizes are counted in abstract states",
+        "infinity");
+    parser.add_option<int>(
+        "memory_bound",
+        "maximum memory in KiB used by the PDBs of the collection, measured "
+        "on the PDBs built during hill climbing",
+        "infinity");
+    parser.add_option<bool>(
+        "improvement_per_byte",
+        "select the candidate that improves the most samples per added byte "
+        "instead of the one that improves the most samples",
+        "false");
+    parser.add_option<bool>(
+        "anytime",
+        "start search with the singleton collection and continue hill "
+        "climbing in a background thread, switching to each improved "
+        "collection as soon as its PDBs are built",
+        "false");
+    parser.add_option<int>(
+        "max_climbing_time",
+        "maximum time in seconds for hill climbing in anytime mode",
+        "300");
+    add_heuristic_cache_options_to_parser(parser);
+    add_incremental_evaluation_option_to_parser(parser);
+    add_statistics_report_options_to_parser(parser);
     Options opts = parser.parse();
+    if (opts.get<int>("max_domain_size") < 2)
+        parser.error("max_domain_size must be at least 2");
+    if (opts.get<int>("memory_bound") < 1)
+        parser.error("memory_bound must be at least 1");
+    if (opts.get<int>("max_climbing_time") < 0)
+        parser.error("max_climbing_time must be non-negative");
+    if (opts.get<bool>("anytime") && opts.get<bool>("incremental"))
+        parser.error("incremental evaluation is not supported in anytime mode");
     if (parser.dry_run())
         return nullptr;
     else
@@ -2,16 +2,66 @@
 #define PLANOPT_HEURISTICS_H_IPDB_H
 
 #include "canonical_pdbs.h"
+#include "canonical_pdbs_evaluator.h"
+#include "pattern_hillclimbing.h"
+#include "statistics_report.h"
 
 #include "../heuristic.h"
 
+#include "../utils/timer.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
 namespace planopt_heuristics {
 class IPDBHeuristic : public Heuristic {
-    CanonicalPatternDatabases cpdbs;
+    // Declared first, so it measures the construction of all other members.
+    utils::Timer construction_timer;
+    std::shared_ptr<CanonicalPatternDatabases> cpdbs;
+    StatisticsReport report;
+    CanonicalPDBsEvaluator evaluator;
+
+    /*
+      In anytime mode, search starts with the singleton collection while a
+      background thread continues hill climbing. The climber keeps the PDBs
+      of its current collection, so for every collection it moves to, the
+      thread builds at most the PDB of the new pattern and publishes copies
+      of all PDBs in published_cpdbs, which compute_heuristic picks up before
+      the next evaluation. A published collection is never modified after
+      publishing, and only the search thread evaluates it. The background thread does not log,
+      since g_log is not thread-safe. Once the thread is done, the search
+      thread joins it and logs the hill climbing statistics.
+    */
+    TNFTask climbing_task;
+    std::unique_ptr<HillClimber> climber;
+    std::shared_ptr<CanonicalPatternDatabases> published_cpdbs;
+    std::atomic<bool> stop_climbing;
+    std::atomic<bool> climbing_finished;
+    double climbing_time;
+    std::thread climbing_thread;
+
+    void climb_in_background(
+        PDBSettings settings, int cache_size, double max_climbing_time);
+    void switch_to_published_cpdbs();
 protected:
     virtual int compute_heuristic(const GlobalState &state) override;
 public:
     explicit IPDBHeuristic(const options::Options &options);
+    virtual ~IPDBHeuristic() override;
+
+    /*
+      Stop the background thread and wait for it. The thread checks for
+      the stop before each PDB it builds, so this waits for at most one PDB
+      and for combining the PDBs of one collection. The planner exits
+      without destroying the heuristic, so we also call this on exit.
+    */
+    void finish_climbing();
+
+    virtual void get_path_dependent_evaluators(std::set<Evaluator *> &evals) override;
+    virtual void notify_state_transition(
+        const GlobalState &parent_state, OperatorID op_id,
+        const GlobalState &state) override;
 };
 }
 #endif
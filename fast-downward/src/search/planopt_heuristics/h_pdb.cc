@@ -6,15 +6,78 @@
 using namespace std;
 
 namespace planopt_heuristics {
+/*
+  Build the PDB and, in incremental mode, the pattern positions changed by
+  each operator, so we only convert the task to TNF once.
+*/
+static PatternDatabase create_pdb(
+    const TaskProxy &task_proxy, const options::Options &options,
+    vector<vector<int>> &changed_pattern_positions) {
+    TNFTask task = create_tnf_task(task_proxy);
+    PatternDatabase pdb(task, options.get_list<int>("pattern"),
+                        get_pdb_settings_from_options(options));
+    if (options.get<bool>("incremental")) {
+        changed_pattern_positions = get_changed_pattern_positions(task, pdb.get_pattern());
+    }
+    return pdb;
+}
+
 PDBHeuristic::PDBHeuristic(const options::Options &options)
     : Heuristic(options),
-      pdb(create_tnf_task(task_proxy), options.get_list<int>("pattern")) {
+      incremental(options.get<bool>("incremental")),
+      pdb(create_pdb(task_proxy, options, changed_pattern_positions)),
+      report(options, "planopt_pdb"),
+      reached_distances(-1),
+      abstract_state_indices(-1) {
+    pdb.print_statistics();
+    report.report_construction(
+        {pdb.get_pattern()}, construction_timer(), pdb.get_statistics().table_bytes,
+        pdb.lookup_distance(task_proxy.get_initial_state().get_values()));
 }
 
-int PDBHeuristic::compute_heuristic(const GlobalState &global_state) {
-    TNFState state = global_state.get_values();
+void PDBHeuristic::get_path_dependent_evaluators(set<Evaluator *> &evals) {
+    if (pdb.uses_mod3_compression() || incremental) {
+        evals.insert(this);
+    }
+}
 
-    int h = pdb.lookup_distance(state);
+void PDBHeuristic::notify_state_transition(
+    const GlobalState &parent_state, OperatorID op_id, const GlobalState &state) {
+    if (incremental) {
+        int parent_index = abstract_state_indices[parent_state];
+        if (parent_index != -1 && abstract_state_indices[state] == -1) {
+            abstract_state_indices[state] = parent_index +
+                pdb.get_projection().get_rank_difference(
+                    changed_pattern_positions[op_id.get_index()], parent_state, state);
+        }
+        return;
+    }
+    int parent_distance = reached_distances[parent_state];
+    if (parent_distance != -1 && reached_distances[state] == -1) {
+        reached_distances[state] = pdb.lookup_distance(state.get_values(), parent_distance);
+    }
+}
+
+int PDBHeuristic::compute_heuristic(const GlobalState &global_state) {
+    int h;
+    if (pdb.uses_mod3_compression()) {
+        h = reached_distances[global_state];
+        if (h == -1) {
+            h = pdb.lookup_distance(global_state.get_values());
+            reached_distances[global_state] = h;
+        }
+    } else if (incremental) {
+        int index = abstract_state_indices[global_state];
+        if (index == -1) {
+            index = pdb.get_abstract_state_index(global_state.get_values());
+            abstract_state_indices[global_state] = index;
+        }
+        h = pdb.lookup_distance_of_index(index);
+    } else {
+        TNFState state = global_state.get_values();
+        h = pdb.lookup_distance(state);
+    }
+    report.report_evaluation(h);
     if (h == numeric_limits<int>::max()) {
         return DEAD_END;
     } else {
@@ -25,7 +88,21 @@ int PDBHeuristic::compute_heuristic(const GlobalState &global_state) {
 static Heuristic *_parse(OptionParser &parser) {
     Heuristic::add_options_to_parser(parser);
     parser.add_list_option<int>("pattern");
+    add_pdb_options_to_parser(parser);
+    add_incremental_evaluation_option_to_parser(parser);
+    add_statistics_report_options_to_parser(parser);
     Options opts = parser.parse();
+    if (get_pdb_settings_from_options(opts).max_domain_size < 2)
+        parser.error("max_domain_size must be at least 2");
+    PDBSettings settings = get_pdb_settings_from_options(opts);
+    if (settings.num_threads < 1)
+        parser.error("threads must be at least 1");
+    if (settings.symbolic && (settings.lazy || settings.is_bounded() ||
+                              settings.compression != PDBCompression::NONE))
+        parser.error("symbolic PDBs cannot be lazy, bounded or compressed");
+    if (opts.get<bool>("incremental") &&
+        (settings.symbolic || settings.compression == PDBCompression::MOD3))
+        parser.error("incremental evaluation does not support symbolic or mod3 PDBs");
     if (parser.dry_run())
         return nullptr;
     else
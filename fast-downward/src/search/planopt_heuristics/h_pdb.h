@@ -2,16 +2,47 @@
 #define PLANOPT_HEURISTICS_H_PDB_H
 
 #include "pdb.h"
+#include "statistics_report.h"
 
 #include "../heuristic.h"
+#include "../per_state_information.h"
+
+#include "../utils/timer.h"
+
+#include <vector>
 
 namespace planopt_heuristics {
 class PDBHeuristic : public Heuristic {
+    // Declared first, so it measures the construction of all other members.
+    utils::Timer construction_timer;
+    /*
+      In incremental mode, we store the rank of the abstract state of every
+      reached state and compute the rank of a successor from the rank of
+      its parent and the pattern variables changed by the operator. The
+      changed positions are declared before the PDB, since both are
+      computed from the same TNF task.
+    */
+    bool incremental;
+    std::vector<std::vector<int>> changed_pattern_positions;
     PatternDatabase pdb;
+    StatisticsReport report;
+    /*
+      With mod-3 compression, the PDB can only cheaply compute the distance
+      of a state relative to the distance of a neighbor. We store the value
+      of every state the search reaches and compute the value of a successor
+      from the value of its parent when the search generates it.
+    */
+    PerStateInformation<int> reached_distances;
+    PerStateInformation<int> abstract_state_indices;
 protected:
     virtual int compute_heuristic(const GlobalState &state) override;
 public:
     explicit PDBHeuristic(const options::Options &options);
+
+    virtual void get_path_dependent_evaluators(std::set<Evaluator *> &evals) override;
+    virtual void notify_state_transition(
+        const GlobalState &parent_state, OperatorID op_id,
+        const GlobalState &state) override;
 };
 }
 #endif
@@ -0,0 +1,51 @@
+#include "h_post_hoc_optimization.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+using namespace std;
+
+namespace planopt_heuristics {
+PostHocOptimizationHeuristic::PostHocOptimizationHeuristic(
+    const options::Options &options)
+    : Heuristic(options),
+      pho(create_tnf_task(task_proxy), options.get_list<vector<int>>("patterns")),
+      report(options, "planopt_pho"),
+      num_evaluations(0) {
+    int initial_h = pho.compute_heuristic(task_proxy.get_initial_state().get_values());
+    pho.print_statistics();
+    report.report_construction(
+        pho.get_patterns(), construction_timer(), pho.get_table_bytes(), initial_h);
+}
+
+int PostHocOptimizationHeuristic::compute_heuristic(const GlobalState &global_state) {
+    TNFState state = global_state.get_values();
+
+    int h = pho.compute_heuristic(state);
+    ++num_evaluations;
+    if (num_evaluations >= (1 << 16) && (num_evaluations & (num_evaluations - 1)) == 0) {
+        // Report at powers of two, so a run killed by a time limit still logs.
+        pho.print_statistics();
+    }
+    report.report_evaluation(h);
+    if (h == numeric_limits<int>::max()) {
+        return DEAD_END;
+    } else {
+        return h;
+    }
+}
+
+static Heuristic *_parse(OptionParser &parser) {
+    Heuristic::add_options_to_parser(parser);
+    parser.add_list_option<vector<int>>("patterns");
+    add_statistics_report_options_to_parser(parser);
+    Options opts = parser.parse();
+    if (parser.dry_run())
+        return nullptr;
+    else
+        return new PostHocOptimizationHeuristic(opts);
+}
+
+static Plugin<Heuristic> _plugin("planopt_pho", _parse);
+
+}
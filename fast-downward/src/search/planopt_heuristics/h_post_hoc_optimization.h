@@ -0,0 +1,24 @@
+#ifndef PLANOPT_HEURISTICS_H_POST_HOC_OPTIMIZATION_H
+#define PLANOPT_HEURISTICS_H_POST_HOC_OPTIMIZATION_H
+
+#include "post_hoc_optimization.h"
+#include "statistics_report.h"
+
+#include "../heuristic.h"
+
+#include "../utils/timer.h"
+
+namespace planopt_heuristics {
+class PostHocOptimizationHeuristic : public Heuristic {
+    // Declared first, so it measures the construction of all other members.
+    utils::Timer construction_timer;
+    PostHocOptimization pho;
+    StatisticsReport report;
+    long long num_evaluations;
+protected:
+    virtual int compute_heuristic(const GlobalState &state) override;
+public:
+    explicit PostHocOptimizationHeuristic(const options::Options &options);
+};
+}
+#endif
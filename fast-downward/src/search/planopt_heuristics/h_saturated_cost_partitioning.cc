@@ -0,0 +1,55 @@
+#include "h_saturated_cost_partitioning.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+using namespace std;
+
+namespace planopt_heuristics {
+SaturatedCostPartitioningHeuristic::SaturatedCostPartitioningHeuristic(
+    const options::Options &options)
+    : Heuristic(options),
+      scp(create_tnf_task(task_proxy), options.get_list<vector<int>>("patterns"),
+          options.get<int>("orders"), options.get<int>("random_seed")),
+      report(options, "planopt_scp") {
+    TNFState initial_state = task_proxy.get_initial_state().get_values();
+    scp.print_statistics(initial_state);
+    report.report_construction(
+        scp.get_patterns(), construction_timer(), scp.get_table_bytes(),
+        scp.compute_heuristic(initial_state));
+}
+
+int SaturatedCostPartitioningHeuristic::compute_heuristic(const GlobalState &global_state) {
+    TNFState state = global_state.get_values();
+
+    int h = scp.compute_heuristic(state);
+    report.report_evaluation(h);
+    if (h == numeric_limits<int>::max()) {
+        return DEAD_END;
+    } else {
+        return h;
+    }
+}
+
+static Heuristic *_parse(OptionParser &parser) {
+    Heuristic::add_options_to_parser(parser);
+    parser.add_list_option<vector<int>>("patterns");
+    parser.add_option<int>(
+        "orders",
+        "number of pattern orders for which a saturated cost partitioning is "
+        "computed; the first order is the given one, all others are random",
+        "1");
+    parser.add_option<int>("random_seed", "seed for the random orders", "2017");
+    add_statistics_report_options_to_parser(parser);
+    Options opts = parser.parse();
+    if (opts.get<int>("orders") < 1)
+        parser.error("orders must be at least 1");
+    if (parser.dry_run())
+        return nullptr;
+    else
+        return new SaturatedCostPartitioningHeuristic(opts);
+}
+
+static Plugin<Heuristic> _plugin("planopt_scp", _parse);
+
+}
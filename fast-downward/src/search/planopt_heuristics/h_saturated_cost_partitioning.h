@@ -0,0 +1,23 @@
+#ifndef PLANOPT_HEURISTICS_H_SATURATED_COST_PARTITIONING_H
+#define PLANOPT_HEURISTICS_H_SATURATED_COST_PARTITIONING_H
+
+#include "saturated_cost_partitioning.h"
+#include "statistics_report.h"
+
+#include "../heuristic.h"
+
+#include "../utils/timer.h"
+
+namespace planopt_heuristics {
+class SaturatedCostPartitioningHeuristic : public Heuristic {
+    // Declared first, so it measures the construction of all other members.
+    utils::Timer construction_timer;
+    SaturatedCostPartitioning scp;
+    StatisticsReport report;
+protected:
+    virtual int compute_heuristic(const GlobalState &state) override;
+public:
+    explicit SaturatedCostPartitioningHeuristic(const options::Options &options);
+};
+}
+#endif
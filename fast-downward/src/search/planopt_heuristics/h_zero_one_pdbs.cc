@@ -0,0 +1,81 @@
+#include "h_zero_one_pdbs.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include "../utils/rng.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace planopt_heuristics {
+enum class CostOrder {
+    GIVEN,
+    REVERSE,
+    RANDOM
+};
+
+static vector<Pattern> get_ordered_patterns(const options::Options &options) {
+    vector<Pattern> patterns = options.get_list<vector<int>>("patterns");
+    CostOrder order = static_cast<CostOrder>(options.get_enum("cost_order"));
+    if (order == CostOrder::REVERSE) {
+        reverse(patterns.begin(), patterns.end());
+    } else if (order == CostOrder::RANDOM) {
+        utils::RandomNumberGenerator rng(options.get<int>("random_seed"));
+        rng.shuffle(patterns);
+    }
+    return patterns;
+}
+
+ZeroOnePDBsHeuristic::ZeroOnePDBsHeuristic(const options::Options &options)
+    : Heuristic(options),
+      pdbs(create_tnf_task(task_proxy), get_ordered_patterns(options),
+           options.get<int>("threads")),
+      report(options, "planopt_zopdbs") {
+    pdbs.print_statistics();
+    report.report_construction(
+        pdbs.get_patterns(), construction_timer(), pdbs.get_table_bytes(),
+        pdbs.compute_heuristic(task_proxy.get_initial_state().get_values()));
+}
+
+int ZeroOnePDBsHeuristic::compute_heuristic(const GlobalState &global_state) {
+    TNFState state = global_state.get_values();
+
+    int h = pdbs.compute_heuristic(state);
+    report.report_evaluation(h);
+    if (h == numeric_limits<int>::max()) {
+        return DEAD_END;
+    } else {
+        return h;
+    }
+}
+
+static Heuristic *_parse(OptionParser &parser) {
+    Heuristic::add_options_to_parser(parser);
+    parser.add_list_option<vector<int>>("patterns");
+    vector<string> cost_orders;
+    cost_orders.push_back("given");
+    cost_orders.push_back("reverse");
+    cost_orders.push_back("random");
+    parser.add_enum_option(
+        "cost_order",
+        cost_orders,
+        "order of the patterns in which operators are assigned: each operator "
+        "keeps its cost in the first pattern it affects",
+        "given");
+    parser.add_option<int>("random_seed", "seed for the random cost order", "2017");
+    parser.add_option<int>("threads", "number of threads building the PDBs", "1");
+    add_statistics_report_options_to_parser(parser);
+    Options opts = parser.parse();
+    if (opts.get<int>("threads") < 1)
+        parser.error("threads must be at least 1");
+    if (parser.dry_run())
+        return nullptr;
+    else
+        return new ZeroOnePDBsHeuristic(opts);
+}
+
+static Plugin<Heuristic> _plugin("planopt_zopdbs", _parse);
+
+}
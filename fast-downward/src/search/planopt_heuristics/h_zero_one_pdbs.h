@@ -0,0 +1,23 @@
+#ifndef PLANOPT_HEURISTICS_H_ZERO_ONE_PDBS_H
+#define PLANOPT_HEURISTICS_H_ZERO_ONE_PDBS_H
+
+#include "statistics_report.h"
+#include "zero_one_pdbs.h"
+
+#include "../heuristic.h"
+
+#include "../utils/timer.h"
+
+namespace planopt_heuristics {
+class ZeroOnePDBsHeuristic : public Heuristic {
+    // Declared first, so it measures the construction of all other members.
+    utils::Timer construction_timer;
+    ZeroOnePDBs pdbs;
+    StatisticsReport report;
+protected:
+    virtual int compute_heuristic(const GlobalState &state) override;
+public:
+    explicit ZeroOnePDBsHeuristic(const options::Options &options);
+};
+}
+#endif
@@ -0,0 +1,143 @@
+#include "heuristic_cache.h"
+
+#include "../option_parser.h"
+
+#include "../utils/logging.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+namespace planopt_heuristics {
+HeuristicCache::HeuristicCache(int key_size, int capacity)
+    : key_size(key_size),
+      clock_hand(0),
+      num_hits(0),
+      num_misses(0),
+      num_evictions(0),
+      num_entries(0) {
+    assert(capacity > 0);
+    size_t num_slots = PROBE_LENGTH;
+    while (num_slots < static_cast<size_t>(capacity)) {
+        num_slots *= 2;
+    }
+    mask = num_slots - 1;
+    keys.resize(num_slots * key_size);
+    values.resize(num_slots);
+    hashes.resize(num_slots);
+    occupied.resize(num_slots, false);
+    referenced.resize(num_slots, false);
+}
+
+size_t HeuristicCache::hash_key(const vector<int> &key) const {
+    // FNV-1a over the ranks, followed by a final mix of the high bits.
+    size_t hash = 2166136261u;
+    for (int rank : key) {
+        hash = (hash ^ static_cast<unsigned int>(rank)) * 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
+
+bool HeuristicCache::matches(size_t slot, size_t hash, const vector<int> &key) const {
+    if (!occupied[slot] || hashes[slot] != hash)
+        return false;
+    const int *stored_key = &keys[slot * key_size];
+    for (int i = 0; i < key_size; ++i) {
+        if (stored_key[i] != key[i])
+            return false;
+    }
+    return true;
+}
+
+void HeuristicCache::store(size_t slot, size_t hash, const vector<int> &key, int value) {
+    copy(key.begin(), key.end(), keys.begin() + slot * key_size);
+    values[slot] = value;
+    hashes[slot] = hash;
+    occupied[slot] = true;
+    referenced[slot] = false;
+}
+
+bool HeuristicCache::lookup(const vector<int> &key, int &value) {
+    assert(static_cast<int>(key.size()) == key_size);
+    size_t hash = hash_key(key);
+    for (int i = 0; i < PROBE_LENGTH; ++i) {
+        size_t slot = (hash + i) & mask;
+        if (!occupied[slot])
+            break;
+        if (matches(slot, hash, key)) {
+            referenced[slot] = true;
+            value = values[slot];
+            ++num_hits;
+            return true;
+        }
+    }
+    ++num_misses;
+    return false;
+}
+
+void HeuristicCache::insert(const vector<int> &key, int value) {
+    assert(static_cast<int>(key.size()) == key_size);
+    size_t hash = hash_key(key);
+    for (int i = 0; i < PROBE_LENGTH; ++i) {
+        size_t slot = (hash + i) & mask;
+        if (!occupied[slot]) {
+            store(slot, hash, key, value);
+            ++num_entries;
+            return;
+        } else if (matches(slot, hash, key)) {
+            values[slot] = value;
+            return;
+        }
+    }
+    /*
+      All slots of the probe window are occupied. After one round of the
+      clock hand all reference bits are cleared, so we find a victim within
+      two rounds.
+    */
+    for (int step = 0; step < 2 * PROBE_LENGTH; ++step) {
+        size_t slot = (hash + clock_hand) & mask;
+        clock_hand = (clock_hand + 1) % PROBE_LENGTH;
+        if (referenced[slot]) {
+            referenced[slot] = false;
+        } else {
+            store(slot, hash, key, value);
+            ++num_evictions;
+            return;
+        }
+    }
+    assert(false);
+}
+
+double HeuristicCache::get_hit_rate() const {
+    long long num_lookups = num_hits + num_misses;
+    return num_lookups ? static_cast<double>(num_hits) / num_lookups : 0;
+}
+
+size_t HeuristicCache::get_memory_usage_in_bytes() const {
+    return keys.capacity() * sizeof(int) +
+           values.capacity() * sizeof(int) +
+           hashes.capacity() * sizeof(size_t) +
+           // vector<bool> packs one bit per slot.
+           (occupied.capacity() + referenced.capacity()) / 8;
+}
+
+void HeuristicCache::print_statistics() const {
+    g_log << "Heuristic cache statistics: slots=" << values.size()
+          << " entries=" << num_entries
+          << " hits=" << num_hits
+          << " misses=" << num_misses
+          << " evictions=" << num_evictions
+          << " hit_rate=" << get_hit_rate()
+          << " bytes=" << get_memory_usage_in_bytes()
+          << endl;
+}
+
+void add_heuristic_cache_options_to_parser(OptionParser &parser) {
+    parser.add_option<int>(
+        "cache_size",
+        "number of tuples of abstract state ranks whose heuristic value is "
+        "cached (rounded up to a power of two); 0 disables the cache",
+        "0");
+}
+}
@@ -0,0 +1,64 @@
+#ifndef PLANOPT_HEURISTICS_HEURISTIC_CACHE_H
+#define PLANOPT_HEURISTICS_HEURISTIC_CACHE_H
+
+#include <cstddef>
+#include <vector>
+
+namespace options {
+class OptionParser;
+class Options;
+}
+
+namespace planopt_heuristics {
+/*
+  Bounded cache that maps the tuple of abstract state ranks of a collection
+  of PDBs to the heuristic value computed from them. Many concrete states
+  project to the same tuple, and for those we can skip the lookups and the
+  maximization over all cliques.
+
+  Keys are stored in full (not only their hash), so a hit always returns the
+  value of the same tuple. The cache uses open addressing, but a key may only
+  be stored in the PROBE_LENGTH slots following its home slot. If all of
+  these are occupied, we replace one of them with the CLOCK strategy: every
+  hit sets the reference bit of a slot, and the clock hand skips (and clears)
+  referenced slots before it evicts one. Since slots are never emptied, a
+  lookup can stop after PROBE_LENGTH slots.
+*/
+class HeuristicCache {
+    static const int PROBE_LENGTH = 8;
+
+    int key_size;
+    std::size_t mask;
+    // Slot i stores its key in keys[i * key_size .. (i + 1) * key_size - 1].
+    std::vector<int> keys;
+    std::vector<int> values;
+    std::vector<std::size_t> hashes;
+    std::vector<bool> occupied;
+    std::vector<bool> referenced;
+    int clock_hand;
+
+    long long num_hits;
+    long long num_misses;
+    long long num_evictions;
+    std::size_t num_entries;
+
+    std::size_t hash_key(const std::vector<int> &key) const;
+    bool matches(std::size_t slot, std::size_t hash, const std::vector<int> &key) const;
+    void store(std::size_t slot, std::size_t hash, const std::vector<int> &key, int value);
+public:
+    // The capacity is rounded up to a power of two.
+    HeuristicCache(int key_size, int capacity);
+
+    // Set value and return true if the key is cached.
+    bool lookup(const std::vector<int> &key, int &value);
+    void insert(const std::vector<int> &key, int value);
+
+    double get_hit_rate() const;
+    std::size_t get_memory_usage_in_bytes() const;
+    void print_statistics() const;
+};
+
+extern void add_heuristic_cache_options_to_parser(options::OptionParser &parser);
+}
+
+#endif
@@ -0,0 +1,288 @@
+#include "pattern_cegar.h"
+
+#include "../utils/logging.h"
+#include "../utils/memory.h"
+#include "../utils/timer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <limits>
+#include <unordered_map>
+
+using namespace std;
+
+namespace planopt_heuristics {
+PatternCEGAR::PatternCEGAR(
+    const TNFTask &task, const vector<int> &goal_variables,
+    int max_pdb_size, int max_collection_size, double max_time)
+    : task(task),
+      max_pdb_size(max_pdb_size),
+      max_collection_size(max_collection_size),
+      max_time(max_time),
+      free_transitions(task.variable_domains.size()),
+      num_iterations(0),
+      num_built_pdbs(0),
+      num_precondition_flaws(0),
+      num_goal_flaws(0),
+      num_merges(0),
+      num_extensions(0),
+      solved(false) {
+    for (const TNFOperator &op : task.operators) {
+        if (op.cost == 0 && op.entries.size() == 1) {
+            const TNFOperatorEntry &entry = op.entries[0];
+            free_transitions[entry.variable_id].emplace(
+                entry.precondition_value, entry.effect_value);
+        }
+    }
+    set<int> initial_variables(goal_variables.begin(), goal_variables.end());
+    for (int var : initial_variables) {
+        add_pattern({var});
+    }
+}
+
+long long PatternCEGAR::get_num_abstract_states(const Pattern &pattern) const {
+    long long num_states = 1;
+    for (int var : pattern) {
+        num_states *= task.variable_domains[var];
+        if (num_states > numeric_limits<int>::max()) {
+            // Stop before the product overflows.
+            return num_states;
+        }
+    }
+    return num_states;
+}
+
+long long PatternCEGAR::get_collection_size() const {
+    long long size = 0;
+    for (const PatternInfo &info : collection) {
+        size += get_num_abstract_states(info.pattern);
+    }
+    return size;
+}
+
+void PatternCEGAR::add_pattern(Pattern &&pattern) {
+    sort(pattern.begin(), pattern.end());
+    PatternInfo info;
+    info.pdb = utils::make_unique_ptr<PatternDatabase>(task, pattern);
+    info.pattern = move(pattern);
+    info.finished = false;
+    collection.push_back(move(info));
+    ++num_built_pdbs;
+}
+
+int PatternCEGAR::find_pattern_with_variable(int var) const {
+    for (size_t i = 0; i < collection.size(); ++i) {
+        const Pattern &pattern = collection[i].pattern;
+        if (binary_search(pattern.begin(), pattern.end(), var)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool PatternCEGAR::extract_abstract_plan(const PatternInfo &info, vector<int> &plan) const {
+    const int INF = numeric_limits<int>::max();
+    const PatternDatabase &pdb = *info.pdb;
+    const Projection &projection = pdb.get_projection();
+    const TNFTask &projected_task = projection.get_projected_task();
+    int initial_index = projection.rank_state(projected_task.initial_state);
+    int goal_index = projection.rank_state(projected_task.goal_state);
+    if (pdb.lookup_distance_of_index(initial_index) == INF) {
+        return false;
+    }
+
+    /*
+      Breadth-first search from the initial state that only follows
+      transitions (s, o, t) on optimal paths, i.e., h(s) = cost(o) + h(t).
+      Following such transitions greedily could run into cycles of
+      operators with cost 0.
+    */
+    unordered_map<int, pair<int, int>> parents;
+    parents[initial_index] = make_pair(-1, -1);
+    deque<int> queue = {initial_index};
+    while (!queue.empty()) {
+        int index = queue.front();
+        queue.pop_front();
+        if (index == goal_index) {
+            break;
+        }
+        TNFState state = projection.unrank_state(index);
+        int distance = pdb.lookup_distance_of_index(index);
+        for (size_t op_id = 0; op_id < projected_task.operators.size(); ++op_id) {
+            const TNFOperator &op = projected_task.operators[op_id];
+            bool applicable = all_of(
+                op.entries.begin(), op.entries.end(),
+                [&](const TNFOperatorEntry &entry) {
+                    return state[entry.variable_id] == entry.precondition_value;
+                });
+            if (!applicable) {
+                continue;
+            }
+            TNFState successor = state;
+            for (const TNFOperatorEntry &entry : op.entries) {
+                successor[entry.variable_id] = entry.effect_value;
+            }
+            int successor_index = projection.rank_state(successor);
+            int successor_distance = pdb.lookup_distance_of_index(successor_index);
+            if (successor_distance != INF && op.cost + successor_distance == distance &&
+                parents.emplace(successor_index, make_pair(index, op_id)).second) {
+                queue.push_back(successor_index);
+            }
+        }
+    }
+    assert(parents.count(goal_index));
+
+    plan.clear();
+    for (int index = goal_index; index != initial_index; index = parents[index].first) {
+        plan.push_back(parents[index].second);
+    }
+    reverse(plan.begin(), plan.end());
+    return true;
+}
+
+bool PatternCEGAR::is_reachable_for_free(int var, int value, int target_value) const {
+    return free_transitions[var].count(make_pair(value, target_value));
+}
+
+vector<int> PatternCEGAR::get_flaws(const PatternInfo &info, const vector<int> &plan) {
+    const Projection &projection = info.pdb->get_projection();
+    TNFState state = task.initial_state;
+    vector<int> flaws;
+    for (int projected_op_id : plan) {
+        const TNFOperator &op = task.operators[
+            projection.get_original_operator_id(projected_op_id)];
+        for (const TNFOperatorEntry &entry : op.entries) {
+            int value = state[entry.variable_id];
+            if (value != entry.precondition_value &&
+                !is_reachable_for_free(entry.variable_id, value, entry.precondition_value)) {
+                flaws.push_back(entry.variable_id);
+            }
+        }
+        if (!flaws.empty()) {
+            ++num_precondition_flaws;
+            return flaws;
+        }
+        for (const TNFOperatorEntry &entry : op.entries) {
+            state[entry.variable_id] = entry.effect_value;
+        }
+    }
+    for (size_t var = 0; var < state.size(); ++var) {
+        if (task.is_relevant(var) && state[var] != task.goal_state[var] &&
+            !is_reachable_for_free(var, state[var], task.goal_state[var])) {
+            flaws.push_back(var);
+        }
+    }
+    if (!flaws.empty()) {
+        ++num_goal_flaws;
+    }
+    return flaws;
+}
+
+bool PatternCEGAR::resolve_flaws(int pattern_index, const vector<int> &flaws) {
+    /*
+      Among all flaws that we can resolve within the size bounds, pick the
+      one that leads to the smallest PDB.
+    */
+    const Pattern &pattern = collection[pattern_index].pattern;
+    long long other_patterns_size =
+        get_collection_size() - get_num_abstract_states(pattern);
+    Pattern best_pattern;
+    long long best_size = numeric_limits<long long>::max();
+    int best_merged_index = -1;
+    for (int var : flaws) {
+        int merged_index = find_pattern_with_variable(var);
+        assert(merged_index != pattern_index);
+        Pattern new_pattern = pattern;
+        long long remaining_size = other_patterns_size;
+        if (merged_index == -1) {
+            new_pattern.push_back(var);
+        } else {
+            const Pattern &merged_pattern = collection[merged_index].pattern;
+            new_pattern.insert(new_pattern.end(), merged_pattern.begin(), merged_pattern.end());
+            remaining_size -= get_num_abstract_states(merged_pattern);
+        }
+        long long size = get_num_abstract_states(new_pattern);
+        if (size <= max_pdb_size && remaining_size + size <= max_collection_size &&
+            size < best_size) {
+            best_pattern = move(new_pattern);
+            best_size = size;
+            best_merged_index = merged_index;
+        }
+    }
+    if (best_pattern.empty()) {
+        return false;
+    }
+
+    if (best_merged_index == -1) {
+        ++num_extensions;
+    } else {
+        ++num_merges;
+    }
+    // Erase the larger index first, so the smaller one stays valid.
+    collection.erase(collection.begin() + max(pattern_index, best_merged_index));
+    if (best_merged_index != -1) {
+        collection.erase(collection.begin() + min(pattern_index, best_merged_index));
+    }
+    add_pattern(move(best_pattern));
+    return true;
+}
+
+vector<Pattern> PatternCEGAR::run() {
+    utils::Timer timer;
+    while (!solved && timer() < max_time) {
+        auto it = find_if(collection.begin(), collection.end(),
+                          [](const PatternInfo &info) {return !info.finished; });
+        if (it == collection.end()) {
+            break;
+        }
+        ++num_iterations;
+        vector<int> plan;
+        if (!extract_abstract_plan(*it, plan)) {
+            // The abstract initial state is a dead end, so the task is unsolvable.
+            solved = true;
+            break;
+        }
+        vector<int> flaws = get_flaws(*it, plan);
+        if (flaws.empty()) {
+            // The abstract plan solves the task, so the PDB is perfect for the initial state.
+            solved = true;
+            break;
+        }
+        if (!resolve_flaws(it - collection.begin(), flaws)) {
+            it->finished = true;
+        }
+    }
+
+    vector<Pattern> patterns;
+    patterns.reserve(collection.size());
+    for (const PatternInfo &info : collection) {
+        patterns.push_back(info.pattern);
+    }
+    print_statistics(timer());
+    return patterns;
+}
+
+vector<PatternDatabase> PatternCEGAR::extract_pdbs() {
+    vector<PatternDatabase> pdbs;
+    pdbs.reserve(collection.size());
+    for (PatternInfo &info : collection) {
+        pdbs.push_back(move(*info.pdb));
+        info.pdb = nullptr;
+    }
+    return pdbs;
+}
+
+void PatternCEGAR::print_statistics(double total_time) const {
+    g_log << "CEGAR pattern statistics: iterations=" << num_iterations
+          << " built_pdbs=" << num_built_pdbs
+          << " precondition_flaws=" << num_precondition_flaws
+          << " goal_flaws=" << num_goal_flaws
+          << " merges=" << num_merges
+          << " extensions=" << num_extensions
+          << " solved=" << solved
+          << " patterns=" << collection.size()
+          << " collection_size=" << get_collection_size()
+          << " total_time=" << total_time << "s" << endl;
+}
+}
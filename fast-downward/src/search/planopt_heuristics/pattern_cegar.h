@@ -0,0 +1,83 @@
+#ifndef PLANOPT_HEURISTICS_PATTERN_CEGAR_H
+#define PLANOPT_HEURISTICS_PATTERN_CEGAR_H
+
+#include "pdb.h"
+
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  Counterexample-guided generation of a pattern collection. We start with
+  one singleton pattern per goal variable and repeatedly pick a pattern
+  whose PDB may still be improved. We extract an optimal abstract plan from
+  its distance table and execute it in the TNF task. If the plan fails, the
+  variables of the violated preconditions (or goals) are flaws of the
+  pattern. We resolve a flaw by merging the pattern with the pattern that
+  already contains the variable or by adding the variable to the pattern.
+  All patterns are disjoint, but an operator can still affect several of
+  them, so the collection is combined with the canonical heuristic.
+*/
+class PatternCEGAR {
+    struct PatternInfo {
+        Pattern pattern;
+        std::unique_ptr<PatternDatabase> pdb;
+        // True if the pattern has no flaw that we can resolve.
+        bool finished;
+    };
+
+    const TNFTask &task;
+    int max_pdb_size;
+    int max_collection_size;
+    double max_time;
+    /*
+      free_transitions[v] contains the pairs (p, e) of values such that an
+      operator of cost 0 changes v from p to e and mentions no other
+      variable. We apply them implicitly when executing abstract plans, so
+      that "forget" operators of variables outside of the pattern do not
+      count as flaws.
+    */
+    std::vector<std::set<std::pair<int, int>>> free_transitions;
+    std::vector<PatternInfo> collection;
+
+    int num_iterations;
+    int num_built_pdbs;
+    int num_precondition_flaws;
+    int num_goal_flaws;
+    int num_merges;
+    int num_extensions;
+    bool solved;
+
+    long long get_num_abstract_states(const Pattern &pattern) const;
+    long long get_collection_size() const;
+    void add_pattern(Pattern &&pattern);
+    int find_pattern_with_variable(int var) const;
+    /*
+      Return the ids of the projected operators of an optimal plan for the
+      abstract initial state, or false if it is a dead end.
+    */
+    bool extract_abstract_plan(const PatternInfo &info, std::vector<int> &plan) const;
+    bool is_reachable_for_free(int var, int value, int target_value) const;
+    /*
+      Execute the plan in the original task and return the variables
+      whose preconditions (or goals) fail at the first step that fails.
+    */
+    std::vector<int> get_flaws(const PatternInfo &info, const std::vector<int> &plan);
+    bool resolve_flaws(int pattern_index, const std::vector<int> &flaws);
+public:
+    PatternCEGAR(const TNFTask &task, const std::vector<int> &goal_variables,
+                 int max_pdb_size, int max_collection_size, double max_time);
+
+    std::vector<Pattern> run();
+    /*
+      Move the PDBs of the collection out, in the order of the patterns
+      returned by run(), so callers do not have to build them again.
+    */
+    std::vector<PatternDatabase> extract_pdbs();
+    void print_statistics(double total_time) const;
+};
+}
+
+#endif
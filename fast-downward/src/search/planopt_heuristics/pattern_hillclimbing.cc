@@ -5,6 +5,12 @@
 #include "../globals.h"
 
 #include "../utils/logging.h"
+#include "../utils/memory.h"
+#include "../utils/timer.h"
+
+#include "../algorithms/max_cliques.h"
+
+#include <algorithm>
 
 using namespace std;
 
@@ -52,30 +58,53 @@ bool HillClimber::fits_size_bound(const std::vector<Pattern> &collection) const
     /** states_with_p stores the number of abstract states achieavable with the variables in pattern p
         values stored in variable_domains[] are explained in line 50 of tnf_task.h
     **/
-    int states = 0;
+    long long states = 0;
     for (auto p : collection) { // for each pattern...
-        int states_with_p = 1;
+        long long states_with_p = 1;
         for (auto v : p) { //... and for each variable in that pattern...
-            states_with_p = states_with_p * task.variable_domains[v]; // multiplies states_with_p by the number of
-                                                                      // values the variable v can assume. doing this
-                                                                      // for every variable will give us the total
-                                                                      // amount of abstract states the pattern p can
-                                                                      // assume.
+            // multiplies states_with_p by the number of (abstract) values
+            // the variable v can assume. doing this for every variable will
+            // give us the total amount of abstract states the pattern p can
+            // assume.
+            states_with_p = states_with_p * get_abstract_domain_size(
+                task.variable_domains[v], settings.max_domain_size);
+            if (states_with_p >= size_bound) { // stop before the product overflows
+                return false;
+            }
         }
         states += states_with_p;
         if (states >= size_bound) {
             return false;
         }
     }
-    return true;
+    /*
+      Every abstract state needs at least one int in the distance table, so
+      this rejects collections that are too large before we build them. The
+      actual memory usage is checked in run().
+    */
+    return static_cast<size_t>(states) * sizeof(int) <= memory_bound;
 }
 
 
-HillClimber::HillClimber(const TNFTask &task, int size_bound, vector<TNFState> &&samples)
+HillClimber::HillClimber(
+    const TNFTask &task, int size_bound, vector<TNFState> &&samples,
+    const PDBSettings &settings, size_t memory_bound,
+    bool maximize_improvement_per_byte, bool verbose)
     : task(task),
       size_bound(size_bound),
+      memory_bound(memory_bound),
+      maximize_improvement_per_byte(maximize_improvement_per_byte),
+      verbose(verbose),
+      settings(settings),
       samples(move(samples)),
-      causally_relevant_variables(compute_causally_relevant_variables(task)){
+      causally_relevant_variables(compute_causally_relevant_variables(task)),
+      keep_pdbs(false),
+      num_iterations(0),
+      num_evaluated_candidates(0),
+      num_cache_hits(0),
+      num_cache_misses(0),
+      num_rejected_by_memory(0),
+      collection_bytes(0) {
 }
 
 
@@ -87,6 +116,8 @@ vector<Pattern> HillClimber::compute_initial_collection() {
     vector<Pattern> collection;
     // TODO: add your code for exercise (f) here.
     for(unsigned int v = 0; v < task.goal_state.size(); v++){
+      if(!task.is_relevant(v)) // its PDB would be 0 everywhere
+        continue;
       Pattern p;
       p.push_back(v);
       collection.push_back(p);
@@ -150,17 +181,97 @@ vector<vector<Pattern>> HillClimber::compute_neighbors(const vector<Pattern> &co
     return neighbors;
 }
 
+const HillClimber::PatternInfo &HillClimber::get_pattern_info(const Pattern &pattern) {
+    auto it = pattern_infos.find(pattern);
+    if (it != pattern_infos.end()) {
+        ++num_cache_hits;
+        return it->second;
+    }
+    ++num_cache_misses;
+    PatternDatabase pdb(task, pattern, settings);
+    PatternInfo &info = pattern_infos[pattern];
+    info.sample_values.reserve(samples.size());
+    for (const TNFState &sample : samples) {
+        info.sample_values.push_back(pdb.lookup_distance(sample));
+    }
+    // Lazy PDBs grow during the lookups, so we measure them afterwards.
+    info.bytes = pdb.get_memory_usage_in_bytes();
+    if (keep_pdbs) {
+        last_built_pdb = utils::make_unique_ptr<PatternDatabase>(move(pdb));
+    }
+    return info;
+}
+
+size_t HillClimber::get_memory_usage_in_bytes(const vector<Pattern> &collection) {
+    size_t bytes = 0;
+    for (const Pattern &pattern : collection) {
+        bytes += get_pattern_info(pattern).bytes;
+    }
+    return bytes;
+}
+
 vector<int> HillClimber::compute_sample_heuristics(const vector<Pattern> &collection) {
-    CanonicalPatternDatabases cpdbs(task, collection);
+    /*
+      This computes the same values as CanonicalPatternDatabases, but takes
+      the values of the individual PDBs from the cache.
+    */
+    vector<const vector<int> *> pattern_values;
+    pattern_values.reserve(collection.size());
+    for (const Pattern &pattern : collection) {
+        pattern_values.push_back(&get_pattern_info(pattern).sample_values);
+    }
+    vector<vector<int>> maximal_additive_sets;
+    max_cliques::compute_max_cliques(
+        build_compatibility_graph(collection, task), maximal_additive_sets);
+
     vector<int> values;
     values.reserve(samples.size());
-    for (const TNFState &sample : samples) {
-        values.push_back(cpdbs.compute_heuristic(sample));
+    vector<int> heuristic_values(collection.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        for (size_t j = 0; j < collection.size(); ++j) {
+            heuristic_values[j] = (*pattern_values[j])[i];
+        }
+        values.push_back(compute_max_additive_sum(maximal_additive_sets, heuristic_values));
     }
     return values;
 }
 
+bool HillClimber::copy_collection_pdbs(
+    const vector<Pattern> &collection, const function<bool()> &should_stop,
+    vector<PatternDatabase> &pdbs) {
+    // Collections only grow, so we never have to remove a PDB.
+    for (const Pattern &pattern : collection) {
+        if (collection_pdbs.count(pattern))
+            continue;
+        if (best_candidate_pdb && best_candidate_pdb->get_pattern() == pattern) {
+            collection_pdbs.emplace(pattern, move(*best_candidate_pdb));
+        } else {
+            if (should_stop())
+                return false;
+            collection_pdbs.emplace(pattern, PatternDatabase(task, pattern, settings));
+        }
+    }
+    best_candidate_pdb = nullptr;
+    pdbs.clear();
+    pdbs.reserve(collection.size());
+    for (const Pattern &pattern : collection) {
+        pdbs.push_back(collection_pdbs.at(pattern));
+    }
+    return true;
+}
+
 vector<Pattern> HillClimber::run() {
+    return run(numeric_limits<double>::infinity(),
+               []() {return false; },
+               nullptr);
+}
+
+vector<Pattern> HillClimber::run(
+    double max_time, const function<bool()> &should_stop,
+    const function<void(vector<PatternDatabase> &&)> &on_improvement) {
+    utils::Timer timer;
+    keep_pdbs = static_cast<bool>(on_improvement);
+    bool interrupted = false;
     vector<Pattern> current_collection = compute_initial_collection();
     vector<int> current_sample_values = compute_sample_heuristics(current_collection);
 
@@ -179,28 +290,93 @@ vector<Pattern> HillClimber::run() {
       modify current_collection.
     */
     // TODO: add your code for exercise (f) here.
-    while(true){
+    while(!interrupted){
+      utils::Timer iteration_timer;
       vector<Pattern> next_collection;
       int improvement = 0;
+      size_t improvement_bytes = 0;
+      size_t current_bytes = get_memory_usage_in_bytes(current_collection);
       vector<vector<Pattern>> neighs = compute_neighbors(current_collection);
       for(auto neigh : neighs){
+        if(timer() >= max_time || should_stop()){
+          // Keep the best candidate found so far, but stop after this iteration.
+          interrupted = true;
+          break;
+        }
+        ++num_evaluated_candidates;
+        last_built_pdb = nullptr;
         vector<int> next_sample_values = compute_sample_heuristics(neigh);
+        size_t next_bytes = get_memory_usage_in_bytes(neigh);
+        if(next_bytes > memory_bound){ // the PDBs are larger than their lower bound in fits_size_bound
+          ++num_rejected_by_memory;
+          continue;
+        }
         int counter = 0;
         for(unsigned int i = 0; i < next_sample_values.size(); i++){
           if(next_sample_values[i] > current_sample_values[i])
             counter++;
         }
-        if(counter > improvement){
+        size_t added_bytes = max<size_t>(next_bytes - current_bytes, 1);
+        bool is_better = counter > improvement;
+        if(maximize_improvement_per_byte && counter > 0 && improvement > 0){
+          // counter / added_bytes > improvement / improvement_bytes without rounding
+          is_better = static_cast<unsigned long long>(counter) * improvement_bytes >
+                      static_cast<unsigned long long>(improvement) * added_bytes;
+        }
+        if(is_better){
           improvement = counter;
+          improvement_bytes = added_bytes;
           next_collection = neigh;
+          // The PDB of the new pattern, unless we built it in an earlier iteration.
+          best_candidate_pdb = move(last_built_pdb);
         }
       }
+      ++num_iterations;
+      if(verbose){
+        g_log << "Hill climbing iteration " << num_iterations
+              << ": candidates=" << neighs.size()
+              << " improvement=" << improvement
+              << " added_bytes=" << improvement_bytes
+              << " collection_bytes=" << current_bytes
+              << " time=" << iteration_timer << endl;
+      }
       if(improvement == 0)
-        return current_collection;
+        break;
       current_collection = next_collection;
       current_sample_values = compute_sample_heuristics(current_collection);
+      if(keep_pdbs){
+        vector<PatternDatabase> pdbs;
+        if(!copy_collection_pdbs(current_collection, should_stop, pdbs)){
+          interrupted = true;
+          break;
+        }
+        on_improvement(move(pdbs));
+      }
+    }
+    last_built_pdb = nullptr;
+    best_candidate_pdb = nullptr;
+    collection_pdbs.clear();
+    if(interrupted && verbose){
+      g_log << "Hill climbing interrupted after " << timer << endl;
     }
 
+    collection_bytes = get_memory_usage_in_bytes(current_collection);
+    if(verbose)
+      print_statistics(timer());
     return current_collection;
 }
+
+void HillClimber::print_statistics(double total_time) const {
+    int num_cache_lookups = num_cache_hits + num_cache_misses;
+    g_log << "Hill climbing statistics: iterations=" << num_iterations
+          << " evaluated_candidates=" << num_evaluated_candidates
+          << " average_iteration_time="
+          << (num_iterations ? total_time / num_iterations : 0) << "s"
+          << " cache_hit_rate="
+          << (num_cache_lookups ? static_cast<double>(num_cache_hits) / num_cache_lookups : 0)
+          << " built_pdbs=" << num_cache_misses
+          << " rejected_by_memory=" << num_rejected_by_memory
+          << " collection_bytes=" << collection_bytes
+          << " total_time=" << total_time << "s" << endl;
+}
 }
\ No newline at end of file
@@ -1,26 +1,102 @@
 #ifndef PLANOPT_HEURISTICS_PATTERN_HILLCLIMBING_H
 #define PLANOPT_HEURISTICS_PATTERN_HILLCLIMBING_H
 
-#include "projection.h"
+#include "pdb.h"
 
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
 namespace planopt_heuristics {
 class HillClimber {
+    struct PatternInfo {
+        std::vector<int> sample_values;
+        // See PatternDatabase::get_memory_usage_in_bytes.
+        std::size_t bytes;
+    };
+
     const TNFTask &task;
     int size_bound;
+    /*
+      Bound on the memory used by the PDBs of a collection, measured on the
+      PDBs built for evaluating it.
+    */
+    std::size_t memory_bound;
+    /*
+      Select the neighbor with the most improved samples per byte it adds
+      instead of the one with the most improved samples.
+    */
+    bool maximize_improvement_per_byte;
+    /*
+      Log every iteration and the statistics at the end of run(). Climbers
+      that run outside of the main thread must not log.
+    */
+    bool verbose;
+    PDBSettings settings;
     std::vector<TNFState> samples;
     const std::vector<std::set<int>> causally_relevant_variables;
 
+    /*
+      Heuristic values of all samples and memory usage for each pattern
+      whose PDB we built so far. A neighbor shares all but one pattern with
+      the current collection, so most PDBs never have to be built twice.
+    */
+    std::map<Pattern, PatternInfo> pattern_infos;
+    /*
+      If run() passes the PDBs of each collection to on_improvement, we keep
+      the PDBs of the current collection and the PDB of the new pattern of
+      the best candidate so far, so that we build at most one PDB when we
+      move to the next collection.
+    */
+    bool keep_pdbs;
+    std::map<Pattern, PatternDatabase> collection_pdbs;
+    std::unique_ptr<PatternDatabase> last_built_pdb;
+    std::unique_ptr<PatternDatabase> best_candidate_pdb;
+
+    int num_iterations;
+    int num_evaluated_candidates;
+    int num_cache_hits;
+    int num_cache_misses;
+    int num_rejected_by_memory;
+    std::size_t collection_bytes;
+
+    const PatternInfo &get_pattern_info(const Pattern &pattern);
+    std::size_t get_memory_usage_in_bytes(const std::vector<Pattern> &collection);
     bool fits_size_bound(const std::vector<Pattern> &collection) const;
     std::vector<Pattern> compute_initial_collection();
     std::vector<std::vector<Pattern>> compute_neighbors(
         const std::vector<Pattern> &collection);
     std::vector<int> compute_sample_heuristics(const std::vector<Pattern> &collection);
+    /*
+      Update collection_pdbs to the given collection and return copies of
+      its PDBs, or false if should_stop returns true in between.
+    */
+    bool copy_collection_pdbs(
+        const std::vector<Pattern> &collection,
+        const std::function<bool()> &should_stop,
+        std::vector<PatternDatabase> &pdbs);
 public:
-    HillClimber(const TNFTask &task, int size_bound, std::vector<TNFState> &&samples);
+    HillClimber(const TNFTask &task, int size_bound, std::vector<TNFState> &&samples,
+                const PDBSettings &settings = PDBSettings(),
+                std::size_t memory_bound = std::numeric_limits<std::size_t>::max(),
+                bool maximize_improvement_per_byte = false,
+                bool verbose = true);
     std::vector<Pattern> run();
+    /*
+      Like run(), but stop climbing once max_time seconds have passed or
+      should_stop returns true, which is checked before each candidate and
+      before each PDB built for on_improvement. Copies of the PDBs of every
+      collection the climber moves to are passed to on_improvement, which
+      may be empty.
+    */
+    std::vector<Pattern> run(
+        double max_time, const std::function<bool()> &should_stop,
+        const std::function<void(std::vector<PatternDatabase> &&)> &on_improvement);
+    void print_statistics(double total_time) const;
 };
 }
 
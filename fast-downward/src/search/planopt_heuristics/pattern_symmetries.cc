@@ -0,0 +1,213 @@
+#include "pattern_symmetries.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <tuple>
+
+using namespace std;
+
+namespace planopt_heuristics {
+/*
+  Encode the operator as its cost followed by its entries sorted by
+  variable, after swapping the variables var1 and var2.
+*/
+static vector<int> encode_operator(const TNFOperator &op, int var1, int var2) {
+    vector<tuple<int, int, int>> entries;
+    entries.reserve(op.entries.size());
+    for (const TNFOperatorEntry &entry : op.entries) {
+        int var = entry.variable_id;
+        if (var == var1) {
+            var = var2;
+        } else if (var == var2) {
+            var = var1;
+        }
+        entries.emplace_back(var, entry.precondition_value, entry.effect_value);
+    }
+    sort(entries.begin(), entries.end());
+    vector<int> key;
+    key.reserve(1 + 3 * entries.size());
+    key.push_back(op.cost);
+    for (const auto &entry : entries) {
+        key.push_back(get<0>(entry));
+        key.push_back(get<1>(entry));
+        key.push_back(get<2>(entry));
+    }
+    return key;
+}
+
+static int find_root(vector<int> &parents, int var) {
+    while (parents[var] != var) {
+        parents[var] = parents[parents[var]];
+        var = parents[var];
+    }
+    return var;
+}
+
+PatternSymmetries::PatternSymmetries()
+    : num_canonical_states(0) {
+}
+
+PatternSymmetries::PatternSymmetries(const Projection &projection)
+    : domain_sizes(projection.get_projected_task().variable_domains),
+      hash_multipliers(projection.get_perfect_hash_multipliers()),
+      num_canonical_states(0) {
+    assert(projection.can_rank_states());
+    compute_classes(projection.get_projected_task());
+    if (!empty()) {
+        compute_canonical_multipliers();
+    }
+}
+
+void PatternSymmetries::compute_classes(const TNFTask &projected_task) {
+    int num_variables = domain_sizes.size();
+    set<vector<int>> operator_keys;
+    vector<vector<int>> operators_by_variable(num_variables);
+    for (size_t op_id = 0; op_id < projected_task.operators.size(); ++op_id) {
+        const TNFOperator &op = projected_task.operators[op_id];
+        operator_keys.insert(encode_operator(op, -1, -1));
+        for (const TNFOperatorEntry &entry : op.entries) {
+            operators_by_variable[entry.variable_id].push_back(op_id);
+        }
+    }
+
+    /*
+      Swapping two variables only changes the operators that mention one
+      of them, so we only need to look these up.
+    */
+    vector<int> parents(num_variables);
+    iota(parents.begin(), parents.end(), 0);
+    for (int var1 = 0; var1 < num_variables; ++var1) {
+        for (int var2 = var1 + 1; var2 < num_variables; ++var2) {
+            if (domain_sizes[var1] != domain_sizes[var2] ||
+                projected_task.goal_state[var1] != projected_task.goal_state[var2] ||
+                find_root(parents, var1) == find_root(parents, var2)) {
+                continue;
+            }
+            bool interchangeable = true;
+            for (int var : {var1, var2}) {
+                for (int op_id : operators_by_variable[var]) {
+                    if (!operator_keys.count(encode_operator(
+                                                 projected_task.operators[op_id], var1, var2))) {
+                        interchangeable = false;
+                        break;
+                    }
+                }
+                if (!interchangeable)
+                    break;
+            }
+            if (interchangeable) {
+                parents[find_root(parents, var2)] = find_root(parents, var1);
+            }
+        }
+    }
+
+    vector<vector<int>> positions_by_root(num_variables);
+    for (int var = 0; var < num_variables; ++var) {
+        positions_by_root[find_root(parents, var)].push_back(var);
+    }
+    vector<bool> in_class(num_variables, false);
+    for (const vector<int> &positions : positions_by_root) {
+        for (size_t begin = 0; begin < positions.size(); begin += MAX_CLASS_SIZE) {
+            size_t end = min(positions.size(), begin + MAX_CLASS_SIZE);
+            if (end - begin < 2)
+                continue;
+            VariableClass variable_class;
+            variable_class.positions.assign(positions.begin() + begin, positions.begin() + end);
+            variable_class.domain_size = domain_sizes[positions[begin]];
+            variable_class.multiplier = 0;
+            for (int position : variable_class.positions) {
+                in_class[position] = true;
+            }
+            classes.push_back(move(variable_class));
+        }
+    }
+    for (int var = 0; var < num_variables; ++var) {
+        if (!in_class[var]) {
+            free_positions.push_back(var);
+        }
+    }
+}
+
+void PatternSymmetries::compute_canonical_multipliers() {
+    int max_n = 0;
+    int max_k = 0;
+    for (const VariableClass &variable_class : classes) {
+        int k = variable_class.positions.size();
+        max_n = max(max_n, variable_class.domain_size + k - 1);
+        max_k = max(max_k, k);
+    }
+    /*
+      We only need binomials that are at most the number of canonical
+      states, which fits into an int. Larger ones are capped.
+    */
+    const long long cap = numeric_limits<int>::max();
+    binomials.assign(max_n + 1, vector<int>(max_k + 1, 0));
+    for (int n = 0; n <= max_n; ++n) {
+        binomials[n][0] = 1;
+        for (int k = 1; k <= min(n, max_k); ++k) {
+            long long value = static_cast<long long>(binomials[n - 1][k - 1]) +
+                binomials[n - 1][k];
+            binomials[n][k] = min(value, cap);
+        }
+    }
+
+    long long multiplier = 1;
+    for (int position : free_positions) {
+        free_multipliers.push_back(multiplier);
+        multiplier *= domain_sizes[position];
+    }
+    for (VariableClass &variable_class : classes) {
+        variable_class.multiplier = multiplier;
+        int k = variable_class.positions.size();
+        multiplier *= binomials[variable_class.domain_size + k - 1][k];
+    }
+    assert(multiplier <= cap);
+    num_canonical_states = multiplier;
+}
+
+int PatternSymmetries::get_canonical_index(int state_index) const {
+    int index = 0;
+    for (size_t i = 0; i < free_positions.size(); ++i) {
+        index += free_multipliers[i] * get_value(state_index, free_positions[i]);
+    }
+    int values[MAX_CLASS_SIZE];
+    for (const VariableClass &variable_class : classes) {
+        int k = variable_class.positions.size();
+        for (int i = 0; i < k; ++i) {
+            // Insertion sort, since classes are small.
+            int value = get_value(state_index, variable_class.positions[i]);
+            int j = i;
+            for (; j > 0 && values[j - 1] > value; --j) {
+                values[j] = values[j - 1];
+            }
+            values[j] = value;
+        }
+        /*
+          Adding i to the i-th smallest value turns the sorted tuple into
+          a strictly increasing one, which we rank with the combinatorial
+          number system.
+        */
+        int rank = 0;
+        for (int i = 0; i < k; ++i) {
+            rank += binomials[values[i] + i][i + 1];
+        }
+        index += variable_class.multiplier * rank;
+    }
+    return index;
+}
+
+size_t PatternSymmetries::get_memory_usage_in_bytes() const {
+    size_t bytes = (domain_sizes.capacity() + hash_multipliers.capacity() +
+                    free_positions.capacity() + free_multipliers.capacity()) * sizeof(int);
+    for (const VariableClass &variable_class : classes) {
+        bytes += sizeof(VariableClass) + variable_class.positions.capacity() * sizeof(int);
+    }
+    for (const vector<int> &row : binomials) {
+        bytes += row.capacity() * sizeof(int);
+    }
+    return bytes;
+}
+}
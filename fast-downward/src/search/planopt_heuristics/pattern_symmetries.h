@@ -0,0 +1,69 @@
+#ifndef PLANOPT_HEURISTICS_PATTERN_SYMMETRIES_H
+#define PLANOPT_HEURISTICS_PATTERN_SYMMETRIES_H
+
+#include "projection.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  Symmetries of a projected task that permute interchangeable variables.
+  Two variables are interchangeable if swapping them (and keeping all
+  values) maps the goal state and the set of operators onto themselves.
+  Such a swap does not change goal distances. If a variable is
+  interchangeable with two others, these are interchangeable as well, so
+  every class of pairwise interchangeable variables induces all
+  permutations of its variables. Sorting the values of each class thus
+  yields a canonical representative of all states with the same goal
+  distance under these permutations.
+
+  We rank canonical states by combining the values of the variables that
+  are in no class with the ranks of the sorted value tuples of the
+  classes. A class of k variables with d values has C(d + k - 1, k)
+  sorted tuples instead of d^k value combinations.
+*/
+class PatternSymmetries {
+    // Classes are split into parts of this size, so we can sort on the stack.
+    static const int MAX_CLASS_SIZE = 32;
+
+    struct VariableClass {
+        // Positions in the pattern, in increasing order.
+        std::vector<int> positions;
+        int domain_size;
+        int multiplier;
+    };
+
+    std::vector<int> domain_sizes;
+    std::vector<int> hash_multipliers;
+    std::vector<VariableClass> classes;
+    // Positions that are in no class, with their multipliers for canonical ranks.
+    std::vector<int> free_positions;
+    std::vector<int> free_multipliers;
+    // binomials[n][k] is n choose k for all values needed by the classes.
+    std::vector<std::vector<int>> binomials;
+    int num_canonical_states;
+
+    void compute_classes(const TNFTask &projected_task);
+    void compute_canonical_multipliers();
+    int get_value(int state_index, int position) const {
+        return state_index / hash_multipliers[position] % domain_sizes[position];
+    }
+public:
+    PatternSymmetries();
+    explicit PatternSymmetries(const Projection &projection);
+
+    // True if no two variables of the pattern are interchangeable.
+    bool empty() const {
+        return classes.empty();
+    }
+    int get_num_canonical_states() const {
+        return num_canonical_states;
+    }
+    // Rank of the canonical representative of the state with the given rank.
+    int get_canonical_index(int state_index) const;
+    std::size_t get_memory_usage_in_bytes() const;
+};
+}
+
+#endif
@@ -1,21 +1,310 @@
 #include "pdb.h"
 
+#include "../option_parser.h"
+
 #include "../utils/logging.h"
+#include "../utils/system.h"
+#include "../utils/timer.h"
 
-#include <queue>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <thread>
+#include <unordered_set>
 
 using namespace std;
 
 namespace planopt_heuristics {
 
 /*
-  An entry in the queue is a tuple (h, i) where h is the goal distance of state i.
-  See comments below for details.
+  Call the given function with the index and the operator cost of every
+  predecessor of the abstract state with the given index.
+*/
+template<typename Callback>
+static void for_each_predecessor(
+    const Projection &projection, int state_index, const Callback &callback) {
+    const TNFTask &projected_task = projection.get_projected_task();
+    TNFState current_state = projection.unrank_state(state_index);
+
+    for (const TNFOperator &tnf_operator : projected_task.operators) {
+        bool is_pred_state_reachable = true;
+        auto pred_state = current_state;
+
+        for (const TNFOperatorEntry &entry : tnf_operator.entries) {
+            // uma entrada de um operador é uma tripla (v,p,e), onde:
+            // v = variável (variable_id)
+            // p = valor da variável antes do operador (precondition_value)
+            // e = valor da variável depois do operator (effect_value)
+            // se os efeitos de todas as entradas forem iguais ao estado atual S,
+            // então trocar os valores de S para os valores das pré-cond,
+            // gerará um estado S' que é predecessor de S
+            if (entry.effect_value != pred_state[entry.variable_id]) {
+                is_pred_state_reachable = false;
+                break;
+            }
+            pred_state[entry.variable_id] = entry.precondition_value;
+        }
+
+        if (!is_pred_state_reachable)
+            continue;
+
+        callback(projection.rank_state(pred_state), tnf_operator.cost);
+    }
+}
+
+/*
+  Call the given function with the index of every successor of the abstract
+  state with the given index, the cost of the operator leading to it and
+  the index of that operator in the projected task.
+*/
+template<typename Callback>
+static void for_each_successor(
+    const Projection &projection, int state_index, const Callback &callback) {
+    const TNFTask &projected_task = projection.get_projected_task();
+    TNFState current_state = projection.unrank_state(state_index);
+
+    for (size_t op_id = 0; op_id < projected_task.operators.size(); ++op_id) {
+        const TNFOperator &tnf_operator = projected_task.operators[op_id];
+        bool is_applicable = true;
+        auto succ_state = current_state;
+        for (const TNFOperatorEntry &entry : tnf_operator.entries) {
+            if (entry.precondition_value != succ_state[entry.variable_id]) {
+                is_applicable = false;
+                break;
+            }
+            succ_state[entry.variable_id] = entry.effect_value;
+        }
+        if (is_applicable) {
+            callback(projection.rank_state(succ_state), tnf_operator.cost, op_id);
+        }
+    }
+}
+
+/*
+  Split the range [0, num_items) into contiguous blocks, one per thread, and
+  call work(thread_id, begin, end) for each block. Ranges with fewer than
+  settings.min_states_per_thread items per thread use fewer threads.
 */
-using QueueEntry = pair<int, int>;
+template<typename Work>
+static void run_in_parallel(
+    const PDBSettings &settings, size_t num_items, const Work &work) {
+    size_t min_items_per_thread = max(1, settings.min_states_per_thread);
+    int used_threads = static_cast<int>(
+        min<size_t>(settings.num_threads,
+                    max<size_t>(1, num_items / min_items_per_thread)));
+    if (used_threads == 1) {
+        work(0, 0, num_items);
+        return;
+    }
+    vector<thread> threads;
+    for (int thread_id = 0; thread_id < used_threads; ++thread_id) {
+        size_t begin = num_items * thread_id / used_threads;
+        size_t end = num_items * (thread_id + 1) / used_threads;
+        threads.emplace_back([&work, thread_id, begin, end]() {
+                work(thread_id, begin, end);
+            });
+    }
+    for (thread &t : threads) {
+        t.join();
+    }
+}
+
+template<typename T>
+static void move_and_clear(vector<vector<T>> &parts, vector<T> &result) {
+    result.clear();
+    for (vector<T> &part : parts) {
+        result.insert(result.end(), part.begin(), part.end());
+        part.clear();
+    }
+}
+
+/*
+  Bitset that several threads can update at the same time. Threads only
+  communicate through the bits, so relaxed memory order is enough; the
+  distances written by a thread are read by others after joining it.
+*/
+class AtomicBitset {
+    vector<atomic<uint64_t>> words;
+public:
+    explicit AtomicBitset(size_t size)
+        : words((size + 63) / 64) {
+        for (atomic<uint64_t> &word : words) {
+            word.store(0, memory_order_relaxed);
+        }
+    }
 
-PatternDatabase::PatternDatabase(const TNFTask &task, const Pattern &pattern)
-    : projection(task, pattern) {
+    bool test(size_t index) const {
+        return (words[index / 64].load(memory_order_relaxed) >> (index % 64)) & 1;
+    }
+
+    // Set the bit and return true if this call set it.
+    bool claim(size_t index) {
+        uint64_t mask = uint64_t(1) << (index % 64);
+        return !(words[index / 64].fetch_or(mask, memory_order_relaxed) & mask);
+    }
+};
+
+void add_pdb_options_to_parser(OptionParser &parser) {
+    parser.add_option<bool>(
+        "lazy",
+        "compute goal distances on demand during search instead of building "
+        "the full table up front",
+        "false");
+    parser.add_option<int>(
+        "max_distance",
+        "stop the backward search of each PDB at this goal distance and use "
+        "the distance reached so far for all unsettled abstract states",
+        "infinity");
+    parser.add_option<int>(
+        "memory_limit",
+        "stop the backward search of each PDB once it uses more than this "
+        "many KiB and use the distance reached so far for all unsettled "
+        "abstract states",
+        "infinity");
+    vector<string> compressions;
+    compressions.push_back("none");
+    compressions.push_back("min");
+    compressions.push_back("mod3");
+    compressions.push_back("symmetry");
+    parser.add_enum_option(
+        "compression",
+        compressions,
+        "store the distance table compressed: \"min\" merges groups of "
+        "compression_factor values of the first pattern variable and keeps "
+        "their minimum distance (lossy), \"mod3\" stores distances modulo 3 "
+        "in two bits per state (only for projections with unit distance "
+        "differences), \"symmetry\" stores one entry per class of states that "
+        "only differ by permuting interchangeable pattern variables; ignored "
+        "for lazy and bounded PDBs. This only shrinks the table kept after "
+        "construction: the backward search still fills an uncompressed "
+        "table, so peak memory during construction is not reduced",
+        "none");
+    parser.add_option<int>(
+        "compression_factor",
+        "number of values of the first pattern variable merged into one "
+        "entry by min compression",
+        "2");
+    parser.add_option<int>(
+        "max_domain_size",
+        "merge the values of pattern variables with larger domains into this "
+        "many abstract values (the goal value keeps its own abstract value)",
+        "infinity");
+    parser.add_option<bool>(
+        "symbolic",
+        "represent the goal distances as BDDs computed by a symbolic backward "
+        "search instead of an explicit table (for very large patterns)",
+        "false");
+    parser.add_option<int>(
+        "threads",
+        "number of threads for the backward search of each PDB with a full "
+        "distance table",
+        "1");
+}
+
+void add_incremental_evaluation_option_to_parser(OptionParser &parser) {
+    parser.add_option<bool>(
+        "incremental",
+        "store the abstract state ranks of every reached state and update "
+        "only the ranks of PDBs affected by the applied operator when a "
+        "successor is generated (uses memory for each state)",
+        "false");
+}
+
+PDBSettings get_pdb_settings_from_options(const Options &opts) {
+    PDBSettings settings;
+    settings.lazy = opts.get<bool>("lazy");
+    settings.max_distance = opts.get<int>("max_distance");
+    settings.memory_limit = opts.get<int>("memory_limit");
+    settings.compression = static_cast<PDBCompression>(opts.get_enum("compression"));
+    settings.compression_factor = opts.get<int>("compression_factor");
+    settings.max_domain_size = opts.get<int>("max_domain_size");
+    settings.symbolic = opts.get<bool>("symbolic");
+    settings.num_threads = opts.get<int>("threads");
+    return settings;
+}
+
+static Projection create_timed_projection(
+    const TNFTask &task, const Pattern &pattern, const PDBSettings &settings,
+    PDBStatistics &statistics) {
+    utils::Timer timer;
+    ValueMapping value_mapping;
+    if (settings.max_domain_size != numeric_limits<int>::max() ||
+        has_irrelevant_variable(task, pattern)) {
+        value_mapping = create_value_mapping(task, pattern, settings.max_domain_size);
+    }
+    Projection projection(task, pattern, value_mapping);
+    statistics.projection_time = timer();
+    statistics.num_operators = task.operators.size();
+    statistics.num_abstract_operators = projection.get_projected_task().operators.size();
+    return projection;
+}
+
+PatternDatabase::PatternDatabase(
+    const TNFTask &task, const Pattern &pattern, const PDBSettings &settings)
+    : projection(create_timed_projection(task, pattern, settings, statistics)),
+      rank_kernel(RankKernel::supports(projection) ? RankKernel(projection) : RankKernel()),
+      settings(settings),
+      distance_table_extracted(false),
+      search_finished(false),
+      default_distance(numeric_limits<int>::max()) {
+    /*
+      Note that we start with the goal state to turn the search into a regression.
+      We also have to switch the role of precondition and effect in operators
+      later on. This is sufficient to turn the search into a regression since
+      the task is in TNF.
+    */
+    const TNFTask &projected_task = projection.get_projected_task();
+    utils::Timer search_timer;
+    if (settings.symbolic) {
+        // The number of abstract states may not even fit into an int.
+        statistics.num_abstract_states = projection.can_rank_states() ?
+            projected_task.get_num_states() : numeric_limits<int>::max();
+        symbolic_search = make_shared<SymbolicSearch>(projected_task);
+        statistics.search_time = search_timer();
+        statistics.table_bytes = get_table_memory_usage_in_bytes();
+        return;
+    }
+    if (!projection.can_rank_states()) {
+        cerr << "Pattern " << get_pattern() << " has too many abstract states "
+             << "to rank them; use symbolic=true for such patterns." << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+    }
+    auto goal_state_index = projection.rank_state(projected_task.goal_state);
+    statistics.num_abstract_states = projected_task.get_num_states();
+    statistics.num_queue_pushes = 1;
+    if (uses_distance_table()) {
+        distances.resize(projected_task.get_num_states(), numeric_limits<int>::max());
+        if (settings.num_threads > 1) {
+            compute_distances_in_parallel(goal_state_index);
+        } else {
+            distances[goal_state_index] = 0;
+            open_list.push(make_pair(distances[goal_state_index], goal_state_index));
+            compute_distances();
+        }
+        statistics.search_time = search_timer();
+        if (settings.compression != PDBCompression::NONE) {
+            utils::Timer compression_timer;
+            compress_distances();
+            statistics.compression_time = compression_timer();
+        }
+        compute_dead_ends();
+    } else {
+        tentative_distances[goal_state_index] = 0;
+        open_list.push(make_pair(0, goal_state_index));
+        if (!settings.lazy) {
+            // Run the bounded search to the end.
+            settle_until(-1);
+        }
+        statistics.search_time = search_timer();
+    }
+    statistics.table_bytes = get_table_memory_usage_in_bytes();
+}
+
+void PatternDatabase::compute_distances() {
     /*
       We want to compute goal distances for all abstract states in the
       projected task. To do so, we start by assuming every abstract state has
@@ -25,68 +314,638 @@ PatternDatabase::PatternDatabase(const TNFTask &task, const Pattern &pattern)
       Instead of searching on the actual states, we use perfect hashing to
       run the search on the hash indices of states. To go from a state s to its
       index use rank(s) and to go from an index i to its state use unrank(i).
-    */
-    const TNFTask &projected_task = projection.get_projected_task();
-    distances.resize(projected_task.get_num_states(), numeric_limits<int>::max());
 
-    /*
       Priority queues usually order entries so the largest entry is the first.
       By using the comparator greater<T> instead of the default less<T>, we
-      change the ordering to sort the smallest element first.
+      change the ordering to sort the smallest element first (see OpenList).
     */
-    priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry>> queue;
+    while (!open_list.empty()) {
+        auto queue_entry = open_list.top();
+        open_list.pop();
+        auto current_state_cost = queue_entry.first;
+        if (current_state_cost > distances[queue_entry.second]) {
+            ++statistics.num_stale_pops;
+            continue;
+        }
+        ++statistics.num_settled_states;
+
+        for_each_predecessor(projection, queue_entry.second,
+                             [&](int pred_state_index, int operator_cost) {
+                int curr_state_cost_with_operator = current_state_cost + operator_cost;
+                if (curr_state_cost_with_operator >= distances[pred_state_index])
+                    return;
+                distances[pred_state_index] = curr_state_cost_with_operator;
+                open_list.push(make_pair(curr_state_cost_with_operator, pred_state_index));
+                ++statistics.num_queue_pushes;
+            });
+    }
+    OpenList().swap(open_list);
+}
+
+void PatternDatabase::compute_distances_in_parallel(int goal_state_index) {
     /*
-      Note that we start with the goal state to turn the search into a regression.
-      We also have to switch the role of precondition and effect in operators
-      later on. This is sufficient to turn the search into a regression since
-      the task is in TNF.
+      Both parallel searches compute exactly the same distances as the
+      sequential uniform cost search. If all operators cost 0 or 1, the
+      distances are BFS levels. Otherwise, we use delta-stepping with a
+      bucket width of the smallest positive operator cost.
     */
-    auto goal_state_index = projection.rank_state(projected_task.goal_state);
+    int min_positive_cost = numeric_limits<int>::max();
+    int max_cost = 0;
+    for (const TNFOperator &op : projection.get_projected_task().operators) {
+        if (op.cost > 0)
+            min_positive_cost = min(min_positive_cost, op.cost);
+        max_cost = max(max_cost, op.cost);
+    }
+    if (max_cost <= 1) {
+        compute_distances_by_parallel_bfs(goal_state_index);
+    } else {
+        compute_distances_by_delta_stepping(goal_state_index, min_positive_cost);
+    }
+}
+
+void PatternDatabase::compute_distances_by_parallel_bfs(int goal_state_index) {
+    /*
+      Level-synchronous search: each level is split into contiguous blocks
+      that the threads expand independently. A state is added to a level by
+      the thread that first sets its bit in the visited set, so every state
+      is written and expanded exactly once.
+
+      States reached with cost 0 belong to the current level, so we close
+      the level under operators with cost 0 before any state of the next
+      level is claimed. Predecessors reached with cost 1 are only collected
+      as candidates until then.
+    */
+    int num_threads = settings.num_threads;
+    AtomicBitset visited(distances.size());
+    visited.claim(goal_state_index);
     distances[goal_state_index] = 0;
-    queue.push(make_pair(distances[goal_state_index], goal_state_index));
+    vector<int> frontier = {goal_state_index};
+    vector<int> candidates;
+    vector<vector<int>> thread_states(num_threads);
+    vector<vector<int>> thread_candidates(num_threads);
+    for (int distance = 0; !frontier.empty(); ++distance) {
+        candidates.clear();
+        while (!frontier.empty()) {
+            statistics.num_settled_states += frontier.size();
+            run_in_parallel(settings, frontier.size(),
+                            [&](int thread_id, size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        for_each_predecessor(projection, frontier[i],
+                                             [&](int pred_state_index, int operator_cost) {
+                                if (visited.test(pred_state_index))
+                                    return;
+                                if (operator_cost == 1) {
+                                    thread_candidates[thread_id].push_back(pred_state_index);
+                                } else if (visited.claim(pred_state_index)) {
+                                    distances[pred_state_index] = distance;
+                                    thread_states[thread_id].push_back(pred_state_index);
+                                }
+                            });
+                    }
+                });
+            move_and_clear(thread_states, frontier);
+            statistics.num_queue_pushes += frontier.size();
+            for (vector<int> &part : thread_candidates) {
+                candidates.insert(candidates.end(), part.begin(), part.end());
+                part.clear();
+            }
+        }
 
-    while(queue.size() > 0) {
-        auto queue_entry = queue.top();
-        queue.pop();
-        auto current_state_cost = queue_entry.first;
-        auto current_state = projection.unrank_state(queue_entry.second);
-        
-        for (auto tnf_operator : projected_task.operators) {
-            bool is_pred_state_reachable = true;
-            auto pred_state = current_state; 
-            
-            for (auto entry : tnf_operator.entries) {
-                // uma entrada de um operador é uma tripla (v,p,e), onde:
-                // v = variável (variable_id)
-                // p = valor da variável antes do operador (precondition_value)
-                // e = valor da variável depois do operator (effect_value)
-                // se os efeitos de todas as entradas forem iguais ao estado atual S,
-                // então trocar os valores de S para os valores das pré-cond, 
-                // gerará um estado S' que é predecessor de S  
-                if (entry.effect_value != pred_state[entry.variable_id]) 
-                    is_pred_state_reachable = false;
-                pred_state[entry.variable_id] = entry.precondition_value;
+        // Candidates may be duplicates or may have been reached with cost 0.
+        run_in_parallel(settings, candidates.size(),
+                        [&](int thread_id, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    int state_index = candidates[i];
+                    if (visited.claim(state_index)) {
+                        distances[state_index] = distance + 1;
+                        thread_states[thread_id].push_back(state_index);
+                    }
+                }
+            });
+        move_and_clear(thread_states, frontier);
+        statistics.num_queue_pushes += frontier.size();
+    }
+}
+
+void PatternDatabase::compute_distances_by_delta_stepping(
+    int goal_state_index, int delta) {
+    /*
+      Delta-stepping (Meyer and Sanders, 2003) keeps the states in buckets
+      of width delta by tentative distance and processes the buckets in
+      increasing order. Within a bucket, the threads relax all edges of
+      cost at most delta ("light" edges) until no state moves into the
+      bucket anymore. Afterwards, they relax the remaining ("heavy") edges
+      of all states removed from the bucket, which only reach later
+      buckets. Tentative distances are lowered with compare-and-swap, and a
+      state is pushed again whenever its distance improves. Entries of
+      states that have moved to an earlier bucket since they were pushed
+      are skipped, like stale entries of the sequential open list.
+    */
+    int num_threads = settings.num_threads;
+    vector<atomic<int>> tentative_distances(distances.size());
+    for (atomic<int> &distance : tentative_distances) {
+        distance.store(numeric_limits<int>::max(), memory_order_relaxed);
+    }
+    tentative_distances[goal_state_index].store(0, memory_order_relaxed);
+
+    map<int, vector<int>> buckets;
+    buckets[0].push_back(goal_state_index);
+    vector<vector<int>> thread_states(num_threads);
+    vector<vector<int>> thread_settled(num_threads);
+    vector<vector<pair<int, int>>> thread_later(num_threads);
+    vector<int> thread_stale_pops(num_threads, 0);
+    vector<int> thread_pushes(num_threads, 0);
+    vector<int> frontier;
+    vector<int> settled;
+
+    while (!buckets.empty()) {
+        int bucket = buckets.begin()->first;
+        frontier.swap(buckets.begin()->second);
+        buckets.erase(buckets.begin());
+        settled.clear();
+
+        auto relax = [&](int thread_id, int state_index, int distance) {
+                atomic<int> &entry = tentative_distances[state_index];
+                int old_distance = entry.load(memory_order_relaxed);
+                while (distance < old_distance) {
+                    if (entry.compare_exchange_weak(old_distance, distance,
+                                                    memory_order_relaxed)) {
+                        ++thread_pushes[thread_id];
+                        if (distance / delta == bucket) {
+                            thread_states[thread_id].push_back(state_index);
+                        } else {
+                            thread_later[thread_id].emplace_back(distance / delta, state_index);
+                        }
+                        return;
+                    }
+                }
+            };
+        auto add_later_states = [&]() {
+                for (vector<pair<int, int>> &part : thread_later) {
+                    for (const pair<int, int> &entry : part) {
+                        buckets[entry.first].push_back(entry.second);
+                    }
+                    part.clear();
+                }
+            };
+
+        while (!frontier.empty()) {
+            run_in_parallel(settings, frontier.size(),
+                            [&](int thread_id, size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        int state_index = frontier[i];
+                        int distance = tentative_distances[state_index].load(memory_order_relaxed);
+                        if (distance / delta != bucket) {
+                            ++thread_stale_pops[thread_id];
+                            continue;
+                        }
+                        thread_settled[thread_id].push_back(state_index);
+                        for_each_predecessor(projection, state_index,
+                                             [&](int pred_state_index, int operator_cost) {
+                                if (operator_cost <= delta)
+                                    relax(thread_id, pred_state_index, distance + operator_cost);
+                            });
+                    }
+                });
+            move_and_clear(thread_states, frontier);
+            for (vector<int> &part : thread_settled) {
+                settled.insert(settled.end(), part.begin(), part.end());
+                part.clear();
             }
-            
-            if (!is_pred_state_reachable) 
-                continue;
-            
-            int curr_state_cost_with_operator = current_state_cost + tnf_operator.cost;
-            auto pred_state_index = projection.rank_state(pred_state);
-            if (curr_state_cost_with_operator >= distances[pred_state_index])
-                continue;
+            add_later_states();
+        }
+
+        // A state is expanded again whenever its distance improves.
+        sort(settled.begin(), settled.end());
+        settled.erase(unique(settled.begin(), settled.end()), settled.end());
+        statistics.num_settled_states += settled.size();
+        run_in_parallel(settings, settled.size(),
+                        [&](int thread_id, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    int state_index = settled[i];
+                    int distance = tentative_distances[state_index].load(memory_order_relaxed);
+                    for_each_predecessor(projection, state_index,
+                                         [&](int pred_state_index, int operator_cost) {
+                            if (operator_cost > delta)
+                                relax(thread_id, pred_state_index, distance + operator_cost);
+                        });
+                }
+            });
+        add_later_states();
+    }
+
+    for (size_t i = 0; i < distances.size(); ++i) {
+        distances[i] = tentative_distances[i].load(memory_order_relaxed);
+    }
+    for (int thread_id = 0; thread_id < num_threads; ++thread_id) {
+        statistics.num_stale_pops += thread_stale_pops[thread_id];
+        statistics.num_queue_pushes += thread_pushes[thread_id];
+    }
+}
+
+void PatternDatabase::compute_dead_ends() {
+    /*
+      The bitmap has one bit per table entry (see get_table_index), so it
+      shrinks along with a compressed table. Mod-3 tables have one entry
+      per abstract state.
+    */
+    bool has_dead_ends = false;
+    if (uses_mod3_compression()) {
+        int num_states = projection.get_projected_task().get_num_states();
+        dead_ends.resize(num_states);
+        for (int index = 0; index < num_states; ++index) {
+            dead_ends[index] = (get_mod3_entry(index) == 3);
+            has_dead_ends = has_dead_ends || dead_ends[index];
+        }
+    } else {
+        dead_ends.resize(distances.size());
+        for (size_t index = 0; index < distances.size(); ++index) {
+            dead_ends[index] = (distances[index] == numeric_limits<int>::max());
+            has_dead_ends = has_dead_ends || dead_ends[index];
+        }
+    }
+    if (!has_dead_ends) {
+        vector<bool>().swap(dead_ends);
+    }
+}
+
+bool PatternDatabase::has_unit_distance_differences() const {
+    /*
+      Mod-3 entries are decoded relative to the distance of the parent state
+      in the search, so the distance may change by at most 1 along every
+      transition of the original task. Such a transition can correspond to a
+      path of several abstract transitions: if an operator has an effect on
+      a variable without precondition, the TNF task first forgets the value
+      of the variable with an operator of cost 0. We thus check all paths
+      that consist of transitions of cost 0 followed by one more transition.
+
+      Distances never decrease along transitions of cost 0, so such a path
+      from s leads to a distance above h(s) + 1 iff a transition from s
+      increases the distance by 2 or more, or a transition of cost 0 leads
+      to a state t with h(t) = h(s) + 1 from which such a path increases
+      the distance at all. We call these states "rising" and compute them
+      backwards along transitions of cost 0 that keep the distance. The
+      distance can never decrease by more than the cost, and transitions
+      into dead ends are fine, since entry 3 marks dead ends.
+    */
+    const int INF = numeric_limits<int>::max();
+    vector<bool> rising(distances.size(), false);
+    vector<int> rising_states;
+    for (size_t index = 0; index < distances.size(); ++index) {
+        int distance = distances[index];
+        if (distance == INF)
+            continue;
+        bool ok = true;
+        for_each_successor(projection, index,
+                           [&](int succ_state_index, int operator_cost, int) {
+                int succ_distance = distances[succ_state_index];
+                if (operator_cost > 1 ||
+                    (succ_distance != INF && succ_distance > distance + 1))
+                    ok = false;
+                else if (succ_distance != INF && succ_distance > distance)
+                    rising[index] = true;
+            });
+        if (!ok)
+            return false;
+        if (rising[index])
+            rising_states.push_back(index);
+    }
+    while (!rising_states.empty()) {
+        int index = rising_states.back();
+        rising_states.pop_back();
+        for_each_predecessor(projection, index,
+                             [&](int pred_state_index, int operator_cost) {
+                if (operator_cost == 0 && !rising[pred_state_index] &&
+                    distances[pred_state_index] == distances[index]) {
+                    rising[pred_state_index] = true;
+                    rising_states.push_back(pred_state_index);
+                }
+            });
+    }
+    for (size_t index = 0; index < distances.size(); ++index) {
+        int distance = distances[index];
+        if (distance == INF || !rising[index])
+            continue;
+        bool ok = true;
+        for_each_predecessor(projection, index,
+                             [&](int pred_state_index, int operator_cost) {
+                if (operator_cost == 0 && distances[pred_state_index] == distance - 1)
+                    ok = false;
+            });
+        if (!ok)
+            return false;
+    }
+    return true;
+}
 
-            distances[pred_state_index] = curr_state_cost_with_operator;
-            queue.push(make_pair(curr_state_cost_with_operator, pred_state_index));
+void PatternDatabase::compress_distances() {
+    if (settings.compression == PDBCompression::MOD3) {
+        if (!has_unit_distance_differences()) {
+            g_log << "Pattern database cannot use mod-3 compression "
+                  << "because goal distances change by more than 1 "
+                  << "along some transition of the original task; "
+                  << "keeping the uncompressed table." << endl;
+            settings.compression = PDBCompression::NONE;
+            return;
+        }
+        /*
+          Entry 3 marks states that cannot reach the goal.
+        */
+        packed_distances.assign((distances.size() + 3) / 4, 0);
+        for (size_t index = 0; index < distances.size(); ++index) {
+            int distance = distances[index];
+            int entry = (distance == numeric_limits<int>::max()) ? 3 : distance % 3;
+            packed_distances[index / 4] |= entry << (2 * (index % 4));
+        }
+        vector<int>().swap(distances);
+    } else if (settings.compression == PDBCompression::MIN) {
+        const TNFTask &projected_task = projection.get_projected_task();
+        if (projected_task.variable_domains.empty() || settings.compression_factor <= 1) {
+            settings.compression = PDBCompression::NONE;
+            return;
+        }
+        int domain_size = projected_task.variable_domains[0];
+        int group_size = settings.compression_factor;
+        int num_groups = (domain_size + group_size - 1) / group_size;
+        vector<int> compressed(distances.size() / domain_size * num_groups,
+                               numeric_limits<int>::max());
+        for (size_t index = 0; index < distances.size(); ++index) {
+            int &entry = compressed[get_table_index(index)];
+            entry = min(entry, distances[index]);
+        }
+        distances.swap(compressed);
+    } else if (settings.compression == PDBCompression::SYMMETRY) {
+        symmetries = PatternSymmetries(projection);
+        if (symmetries.empty()) {
+            settings.compression = PDBCompression::NONE;
+            return;
+        }
+        // Symmetric states have the same distance, so any of them will do.
+        vector<int> compressed(symmetries.get_num_canonical_states());
+        for (size_t index = 0; index < distances.size(); ++index) {
+            compressed[get_table_index(index)] = distances[index];
         }
+        distances.swap(compressed);
     }
 }
 
+int PatternDatabase::get_table_index(int state_index) const {
+    if (settings.compression == PDBCompression::SYMMETRY) {
+        return symmetries.get_canonical_index(state_index);
+    } else if (settings.compression != PDBCompression::MIN) {
+        return state_index;
+    }
+    /*
+      The first pattern variable has multiplier 1, so its value is the
+      remainder of dividing the rank by its domain size.
+    */
+    int domain_size = projection.get_projected_task().variable_domains[0];
+    int group_size = settings.compression_factor;
+    int num_groups = (domain_size + group_size - 1) / group_size;
+    int value = state_index % domain_size;
+    return (state_index / domain_size) * num_groups + value / group_size;
+}
+
+int PatternDatabase::get_mod3_entry(int state_index) const {
+    return (packed_distances[state_index / 4] >> (2 * (state_index % 4))) & 3;
+}
+
+int PatternDatabase::reconstruct_mod3_distance(int state_index) const {
+    /*
+      Without a neighbor with known distance, we follow an optimal abstract
+      plan to the goal and count its cost. Since all transitions change the
+      distance by at most 1, a successor reached with cost 1 whose entry is
+      one less (modulo 3) is one step closer to the goal, and a successor
+      reached with cost 0 and the same entry has the same distance. We
+      search the states with the same distance until we find the goal or
+      a step closer to it.
+    */
+    int entry = get_mod3_entry(state_index);
+    if (entry == 3) {
+        return numeric_limits<int>::max();
+    }
+    int goal_state_index = projection.rank_state(projection.get_projected_task().goal_state);
+    int distance = 0;
+    vector<int> level_queue = {state_index};
+    unordered_set<int> seen;
+    while (true) {
+        int closer_entry = (entry + 2) % 3;
+        int next_state_index = -1;
+        seen.clear();
+        seen.insert(level_queue[0]);
+        for (size_t i = 0; i < level_queue.size() && next_state_index == -1; ++i) {
+            int current = level_queue[i];
+            if (current == goal_state_index) {
+                return distance;
+            }
+            for_each_successor(projection, current,
+                               [&](int succ_state_index, int operator_cost, int) {
+                    int succ_entry = get_mod3_entry(succ_state_index);
+                    if (operator_cost == 1 && succ_entry == closer_entry) {
+                        next_state_index = succ_state_index;
+                    } else if (operator_cost == 0 && succ_entry == entry &&
+                               seen.insert(succ_state_index).second) {
+                        level_queue.push_back(succ_state_index);
+                    }
+                });
+        }
+        // The goal distance is finite, so we must have found a step closer.
+        assert(next_state_index != -1);
+        ++distance;
+        entry = closer_entry;
+        level_queue.assign(1, next_state_index);
+    }
+}
+
+size_t PatternDatabase::get_search_memory_usage_in_bytes() const {
+    /*
+      We approximate the size of a node in the unordered_map as the entry
+      plus two pointers (bucket and chain).
+    */
+    size_t tentative_entry_size = sizeof(pair<const int, int>) + 2 * sizeof(void *);
+    return settled_distances.get_memory_usage_in_bytes() +
+           tentative_distances.size() * tentative_entry_size +
+           open_list.size() * sizeof(QueueEntry);
+}
+
+size_t PatternDatabase::get_memory_usage_in_bytes() const {
+    // The settled distances are part of both the search and the table.
+    return projection.get_memory_usage_in_bytes() + get_table_memory_usage_in_bytes() +
+           get_search_memory_usage_in_bytes() - settled_distances.get_memory_usage_in_bytes();
+}
+
+size_t PatternDatabase::get_table_memory_usage_in_bytes() const {
+    return distances.capacity() * sizeof(int) +
+           packed_distances.capacity() * sizeof(unsigned char) +
+           settled_distances.get_memory_usage_in_bytes() +
+           get_dead_end_memory_usage_in_bytes() +
+           symmetries.get_memory_usage_in_bytes() +
+           (symbolic_search ? symbolic_search->get_memory_usage_in_bytes() : 0);
+}
+
+void PatternDatabase::finish_search(int distance) const {
+    search_finished = true;
+    default_distance = distance;
+    OpenList().swap(open_list);
+    unordered_map<int, int>().swap(tentative_distances);
+    statistics.table_bytes = get_table_memory_usage_in_bytes();
+}
+
+int PatternDatabase::settle_until(int state_index) const {
+    /*
+      Resume the backward search until the given state is settled, i.e., until
+      it is removed from the open list with its final goal distance. Since the
+      search is a uniform cost search, all states with a smaller distance are
+      settled on the way. If the open list runs empty first, the state cannot
+      reach the goal.
+
+      If the search exceeds its bounds, we stop it for good. All states that
+      are not settled yet have a goal distance of at least the cost of the
+      cheapest entry on the open list at that point.
+    */
+    size_t memory_limit_in_bytes = static_cast<size_t>(settings.memory_limit) * 1024;
+    while (!open_list.empty()) {
+        auto queue_entry = open_list.top();
+        int current_state_cost = queue_entry.first;
+        int current_state_index = queue_entry.second;
+        auto tentative = tentative_distances.find(current_state_index);
+        if (tentative == tentative_distances.end() ||
+            current_state_cost > tentative->second) {
+            open_list.pop();
+            ++statistics.num_stale_pops;
+            continue;
+        }
+        if (current_state_cost > settings.max_distance ||
+            (settings.memory_limit != numeric_limits<int>::max() &&
+             get_search_memory_usage_in_bytes() > memory_limit_in_bytes)) {
+            finish_search(current_state_cost);
+            return default_distance;
+        }
+        open_list.pop();
+        tentative_distances.erase(tentative);
+        settled_distances.insert(current_state_index, current_state_cost);
+        ++statistics.num_settled_states;
+
+        for_each_predecessor(projection, current_state_index,
+                             [&](int pred_state_index, int operator_cost) {
+                if (settled_distances.contains(pred_state_index))
+                    return;
+                int cost = current_state_cost + operator_cost;
+                auto it = tentative_distances.find(pred_state_index);
+                if (it != tentative_distances.end() && cost >= it->second)
+                    return;
+                tentative_distances[pred_state_index] = cost;
+                open_list.push(make_pair(cost, pred_state_index));
+                ++statistics.num_queue_pushes;
+            });
+
+        if (current_state_index == state_index)
+            return current_state_cost;
+    }
+    finish_search(numeric_limits<int>::max());
+    return default_distance;
+}
+
 int PatternDatabase::lookup_distance(const TNFState &original_state) const {
-    TNFState abstract_state = projection.project_state(original_state);
-    int index = projection.rank_state(abstract_state);
-    return distances[index];
+    if (symbolic_search) {
+        return symbolic_search->lookup_distance(projection.project_state(original_state));
+    }
+    return lookup_distance_of_index(get_abstract_state_index(original_state));
+}
+
+int PatternDatabase::lookup_distance_of_index(int index) const {
+    if (uses_mod3_compression()) {
+        return reconstruct_mod3_distance(index);
+    } else if (uses_distance_table()) {
+        if (distance_table_extracted) {
+            cerr << "Lookup in PDB " << get_pattern()
+                 << " after its distance table was extracted." << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+        }
+        return distances[get_table_index(index)];
+    }
+    int distance = settled_distances.lookup(index, -1);
+    if (distance != -1) {
+        return distance;
+    } else if (search_finished) {
+        return default_distance;
+    }
+    return settle_until(index);
+}
+
+int PatternDatabase::lookup_distance(
+    const TNFState &original_state, int neighbor_distance) const {
+    if (!uses_mod3_compression() || neighbor_distance == numeric_limits<int>::max()) {
+        return lookup_distance(original_state);
+    }
+    int entry = get_mod3_entry(get_abstract_state_index(original_state));
+    if (entry == 3) {
+        return numeric_limits<int>::max();
+    }
+    /*
+      The distance differs from neighbor_distance by at most 1, so the
+      entry determines it uniquely.
+    */
+    int difference = (entry - neighbor_distance % 3 + 3) % 3;
+    if (difference == 0) {
+        return neighbor_distance;
+    } else if (difference == 1) {
+        return neighbor_distance + 1;
+    } else {
+        return neighbor_distance - 1;
+    }
+}
 
+vector<int> PatternDatabase::compute_saturated_costs(int num_operators) const {
+    /*
+      The saturated cost of an operator is the minimal cost that preserves
+      all goal distances of the PDB: the maximum of h(s) - h(t) over all
+      abstract transitions s -> t induced by the operator where h(s) is
+      finite. Transitions from dead ends impose no constraint. We never
+      use negative costs, so operators that do not affect the pattern
+      (and are therefore missing in the projection) get cost 0.
+    */
+    assert(has_plain_distance_table());
+    vector<int> saturated_costs(num_operators, 0);
+    for (size_t index = 0; index < distances.size(); ++index) {
+        int distance = distances[index];
+        if (distance == numeric_limits<int>::max())
+            continue;
+        for_each_successor(projection, index,
+                           [&](int succ_state_index, int, int op_id) {
+                int succ_distance = distances[succ_state_index];
+                if (succ_distance == numeric_limits<int>::max())
+                    return;
+                int &cost = saturated_costs[projection.get_original_operator_id(op_id)];
+                cost = max(cost, distance - succ_distance);
+            });
+    }
+    return saturated_costs;
+}
+
+void PatternDatabase::print_statistics() const {
+    // Lazy PDBs grow during the search.
+    if (!uses_distance_table()) {
+        statistics.table_bytes = get_table_memory_usage_in_bytes();
+    }
+    g_log << "PDB statistics: pattern=" << get_pattern()
+          << " abstract_states=" << statistics.num_abstract_states
+          << " settled_states=" << statistics.num_settled_states
+          << " queue_pushes=" << statistics.num_queue_pushes
+          << " stale_pops=" << statistics.num_stale_pops
+          << " operators=" << statistics.num_operators
+          << " abstract_operators=" << statistics.num_abstract_operators
+          << " table_bytes=" << statistics.table_bytes
+          << " projection_time=" << statistics.projection_time << "s"
+          << " search_time=" << statistics.search_time << "s"
+          << " compression_time=" << statistics.compression_time << "s"
+          << endl;
+    if (symbolic_search) {
+        g_log << "Symbolic PDB statistics: pattern=" << get_pattern()
+              << " layers=" << symbolic_search->get_num_layers()
+              << " peak_nodes=" << symbolic_search->get_peak_nodes()
+              << endl;
+    }
 }
 
 }
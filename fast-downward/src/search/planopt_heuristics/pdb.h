@@ -1,19 +1,275 @@
 #ifndef PLANOPT_HEURISTICS_PDB_H
 #define PLANOPT_HEURISTICS_PDB_H
 
+#include "distance_hash_table.h"
+#include "pattern_symmetries.h"
 #include "projection.h"
+#include "rank_kernel.h"
+#include "symbolic_pdb.h"
 
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+namespace options {
+class OptionParser;
+class Options;
+}
+
 namespace planopt_heuristics {
 
+/*
+  Compression is applied to the full distance table after the backward
+  search, so it reduces the memory used by a finished PDB, but not the peak
+  memory of building it.
+*/
+enum class PDBCompression {
+    NONE,
+    /*
+      Merge groups of compression_factor adjacent values of the first pattern
+      variable (the one with multiplier 1) into a single entry that stores
+      the minimum goal distance of the group.
+    */
+    MIN,
+    /*
+      Store goal distances modulo 3 in two bits per abstract state. This
+      only works if all abstract transitions have cost 0 or 1 and connect
+      states whose goal distances differ by at most 1. Distances can then be
+      reconstructed relative to the distance of a neighboring state. If the
+      projection does not satisfy this, the table is not compressed.
+    */
+    MOD3,
+    /*
+      Store one entry for all states that are equal up to permutations of
+      interchangeable pattern variables (see PatternSymmetries). This is
+      lossless. If the pattern has no such variables, the table is not
+      compressed.
+    */
+    SYMMETRY
+};
+
+struct PDBSettings {
+    // Compute goal distances on demand instead of in the constructor.
+    bool lazy = false;
+    /*
+      Stop the backward search once it would settle a state with a goal
+      distance above max_distance or once its data structures use more than
+      memory_limit KiB. Every state that is not settled at that point gets
+      the smallest distance still on the open list, which is a lower bound
+      on its true goal distance.
+    */
+    int max_distance = std::numeric_limits<int>::max();
+    int memory_limit = std::numeric_limits<int>::max();
+    PDBCompression compression = PDBCompression::NONE;
+    int compression_factor = 2;
+    /*
+      Combine the projection with a domain abstraction that merges the
+      values of pattern variables with larger domains into this many
+      abstract values (see create_value_mapping).
+    */
+    int max_domain_size = std::numeric_limits<int>::max();
+    /*
+      Represent the goal distances symbolically as BDDs (see SymbolicSearch)
+      instead of a table indexed by the ranks of abstract states. This works
+      for patterns whose tables would not fit into memory.
+    */
+    bool symbolic = false;
+    /*
+      Number of threads for the backward search that fills a full distance
+      table (see compute_distances_in_parallel). Lazy, bounded and symbolic
+      PDBs always search sequentially.
+    */
+    int num_threads = 1;
+    /*
+      The parallel search only splits a layer of states among threads if
+      each thread gets at least this many states. Starting threads costs
+      more than expanding a few states, but tests set this to 1 to run the
+      threads concurrently on small tasks.
+    */
+    int min_states_per_thread = 1024;
+
+    bool is_bounded() const {
+        return max_distance != std::numeric_limits<int>::max() ||
+               memory_limit != std::numeric_limits<int>::max();
+    }
+};
+
+/*
+  Numbers collected while building (and, for lazy PDBs, using) a PDB. Times
+  are in seconds.
+*/
+struct PDBStatistics {
+    double projection_time = 0;
+    double search_time = 0;
+    double compression_time = 0;
+    int num_abstract_states = 0;
+    int num_settled_states = 0;
+    int num_queue_pushes = 0;
+    int num_stale_pops = 0;
+    int num_operators = 0;
+    int num_abstract_operators = 0;
+    std::size_t table_bytes = 0;
+};
+
+extern void add_pdb_options_to_parser(options::OptionParser &parser);
+extern PDBSettings get_pdb_settings_from_options(const options::Options &opts);
+/*
+  Add the option "incremental", which makes a PDB heuristic store the ranks
+  of the abstract states of every reached state and compute the ranks of
+  successors from the ranks of their parent.
+*/
+extern void add_incremental_evaluation_option_to_parser(options::OptionParser &parser);
+
 class PatternDatabase {
+    /*
+      An entry in the queue is a tuple (h, i) where h is the goal distance of state i.
+    */
+    using QueueEntry = std::pair<int, int>;
+    using OpenList = std::priority_queue<
+        QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>>;
+
+    mutable PDBStatistics statistics;
     Projection projection;
+    // Ranks original states on the hot path if the pattern is small.
+    RankKernel rank_kernel;
+    PDBSettings settings;
     std::vector<int> distances;
+    // True once extract_distance_table has moved the table out.
+    bool distance_table_extracted;
+    // With MOD3 compression, four 2-bit entries are packed into each byte.
+    std::vector<unsigned char> packed_distances;
+    /*
+      One bit per table entry (see get_table_index) that is set if its
+      states cannot reach the goal. Only PDBs with a full table and at
+      least one dead end have it. It is kept when the distance table is
+      extracted.
+    */
+    std::vector<bool> dead_ends;
+    // Maps ranks to table entries with symmetry compression.
+    PatternSymmetries symmetries;
+
+    /*
+      In lazy or bounded mode, the table above stays empty. Instead, the
+      distances of settled states are stored in a hash table, and the open
+      list of the backward search is kept until the search is finished, so
+      that a lazy PDB can continue the search when a state is queried whose
+      goal distance is not known yet. Once the search is finished, all
+      states that are not in the hash table have the distance
+      default_distance.
+    */
+    mutable OpenList open_list;
+    mutable DistanceHashTable settled_distances;
+    mutable std::unordered_map<int, int> tentative_distances;
+    mutable bool search_finished;
+    mutable int default_distance;
+
+    // Copies of the PDB share the search, which is not modified after construction.
+    std::shared_ptr<const SymbolicSearch> symbolic_search;
+
+    bool uses_distance_table() const {
+        return !settings.lazy && !settings.is_bounded() && !settings.symbolic;
+    }
+    void compute_distances();
+    void compute_distances_in_parallel(int goal_state_index);
+    void compute_distances_by_parallel_bfs(int goal_state_index);
+    void compute_distances_by_delta_stepping(int goal_state_index, int delta);
+    bool has_unit_distance_differences() const;
+    void compute_dead_ends();
+    void compress_distances();
+    int get_table_index(int state_index) const;
+    int get_mod3_entry(int state_index) const;
+    int reconstruct_mod3_distance(int state_index) const;
+    std::size_t get_search_memory_usage_in_bytes() const;
+    std::size_t get_table_memory_usage_in_bytes() const;
+    void finish_search(int distance) const;
+    int settle_until(int state_index) const;
 public:
-    PatternDatabase(const TNFTask &task, const Pattern &pattern);
+    PatternDatabase(const TNFTask &task, const Pattern &pattern,
+                    const PDBSettings &settings = PDBSettings());
 
     int lookup_distance(const TNFState &original_state) const;
+    /*
+      Split lookup_distance into computing the rank of the abstract state
+      and looking up the distance of that rank, for callers that want to
+      use the ranks themselves (e.g., as a cache key).
+    */
+    int get_abstract_state_index(const TNFState &original_state) const {
+        assert(!settings.symbolic);
+        if (rank_kernel.is_specialized())
+            return rank_kernel.rank_original_state(original_state);
+        return projection.rank_original_state(original_state);
+    }
+    int lookup_distance_of_index(int state_index) const;
+    /*
+      Same as lookup_distance(original_state), but the PDB may use the goal
+      distance of a state that is connected to original_state by an operator
+      (as returned by this PDB) to speed up the lookup. This matters for
+      MOD3 compression, where looking up a distance without a neighbor has to
+      walk to the goal in the abstract state space.
+    */
+    int lookup_distance(const TNFState &original_state, int neighbor_distance) const;
+
+    const Pattern &get_pattern() const {
+        return projection.get_pattern();
+    }
+    const Projection &get_projection() const {
+        return projection;
+    }
+
+    // True if the PDB has a full, uncompressed table of all goal distances.
+    bool has_plain_distance_table() const {
+        return uses_distance_table() && settings.compression == PDBCompression::NONE &&
+               !distance_table_extracted;
+    }
+    /*
+      Move the distance table out of the PDB, e.g., to store it in a
+      PDBBank. Lookups in the PDB stop the planner afterwards.
+    */
+    std::vector<int> extract_distance_table() {
+        distance_table_extracted = true;
+        return std::move(distances);
+    }
+
+    bool has_dead_end_bitmap() const {
+        return !dead_ends.empty();
+    }
+    // Only call this if the PDB has a dead-end bitmap.
+    bool is_dead_end_index(int state_index) const {
+        assert(has_dead_end_bitmap());
+        return dead_ends[get_table_index(state_index)];
+    }
+    std::size_t get_dead_end_memory_usage_in_bytes() const {
+        return dead_ends.capacity() / 8;
+    }
+
+    /*
+      Return the saturated cost function of the PDB, i.e., the minimal
+      nonnegative cost of each operator of the original task (indexed like
+      the operators of the task the PDB was built from) under which all goal
+      distances stay the same. Only supported for PDBs with a plain
+      distance table.
+    */
+    std::vector<int> compute_saturated_costs(int num_operators) const;
+
+    /*
+      Memory used by the projection, the goal distances and (for lazy
+      PDBs) the state of the backward search.
+    */
+    std::size_t get_memory_usage_in_bytes() const;
+
+    const PDBStatistics &get_statistics() const {
+        return statistics;
+    }
+    void print_statistics() const;
+
+    bool uses_mod3_compression() const {
+        return settings.compression == PDBCompression::MOD3;
+    }
 };
 }
 
@@ -0,0 +1,153 @@
+#include "pdb_bank.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+using namespace std;
+
+namespace planopt_heuristics {
+static const size_t CACHE_LINE_SIZE = 64;
+static const size_t ENTRIES_PER_CACHE_LINE = CACHE_LINE_SIZE / sizeof(int);
+/*
+  Tables up to this size (in bytes) are likely to stay in the L1/L2 cache
+  across evaluations, so prefetching them only costs instructions.
+*/
+static const size_t PREFETCH_THRESHOLD = 32 * 1024;
+
+static size_t round_up_to_cache_line(size_t num_entries) {
+    return (num_entries + ENTRIES_PER_CACHE_LINE - 1) /
+           ENTRIES_PER_CACHE_LINE * ENTRIES_PER_CACHE_LINE;
+}
+
+static inline void prefetch(const int *address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+static int *resize_arena(int *data, size_t num_entries) {
+    int *resized_data = static_cast<int *>(realloc(data, num_entries * sizeof(int)));
+    if (!resized_data) {
+        free(data);
+        throw bad_alloc();
+    }
+    return resized_data;
+}
+
+bool PDBBank::supports(const vector<PatternDatabase> &pdbs) {
+    for (const PatternDatabase &pdb : pdbs) {
+        if (!pdb.has_plain_distance_table())
+            return false;
+    }
+    return true;
+}
+
+PDBBank::PDBBank(vector<PatternDatabase> &pdbs) {
+    assert(supports(pdbs));
+    size_t num_table_entries = 0;
+    for (PatternDatabase &pdb : pdbs) {
+        const Projection &projection = pdb.get_projection();
+        PDBInfo info;
+        if (RankKernel::supports(projection)) {
+            info.rank_kernel = RankKernel(projection);
+        }
+        info.first_variable = variables.size();
+        info.num_variables = projection.get_pattern().size();
+        info.has_value_mapping = projection.has_value_mapping();
+        info.table_offset = num_table_entries;
+        size_t table_size = projection.get_projected_task().get_num_states();
+        info.prefetch = table_size * sizeof(int) > PREFETCH_THRESHOLD;
+        pdb_infos.push_back(info);
+
+        variables.insert(variables.end(), projection.get_pattern().begin(),
+                         projection.get_pattern().end());
+        multipliers.insert(multipliers.end(),
+                           projection.get_perfect_hash_multipliers().begin(),
+                           projection.get_perfect_hash_multipliers().end());
+        for (size_t j = 0; j < projection.get_pattern().size(); ++j) {
+            value_offsets.push_back(mapped_values.size());
+            if (info.has_value_mapping) {
+                const vector<int> &mapping = projection.get_value_mapping()[j];
+                mapped_values.insert(mapped_values.end(), mapping.begin(), mapping.end());
+            }
+        }
+        num_table_entries += round_up_to_cache_line(table_size);
+    }
+
+    /*
+      We grow the arena table by table and free each table right after
+      copying it, so that we never hold more than the arena and the
+      remaining tables. Unlike vector, realloc can grow large allocations
+      without copying them. We allocate one extra cache line, so we can
+      start the arena at an aligned address.
+    */
+    int *data = nullptr;
+    for (size_t i = 0; i < pdbs.size(); ++i) {
+        size_t table_end = (i + 1 < pdbs.size()) ?
+            pdb_infos[i + 1].table_offset : num_table_entries;
+        data = resize_arena(data, table_end);
+        vector<int> distances = pdbs[i].extract_distance_table();
+        copy(distances.begin(), distances.end(), data + pdb_infos[i].table_offset);
+    }
+    arena_size = num_table_entries + ENTRIES_PER_CACHE_LINE;
+    data = resize_arena(data, arena_size);
+    arena.reset(data);
+
+    uintptr_t address = reinterpret_cast<uintptr_t>(data);
+    size_t misalignment = address % CACHE_LINE_SIZE;
+    arena_start = misalignment ? (CACHE_LINE_SIZE - misalignment) / sizeof(int) : 0;
+    if (arena_start) {
+        memmove(data + arena_start, data, num_table_entries * sizeof(int));
+    }
+}
+
+void PDBBank::compute_abstract_state_indices(
+    const TNFState &original_state, vector<int> &state_indices) const {
+    state_indices.resize(pdb_infos.size());
+    const int *table_start = arena.get() + arena_start;
+    for (size_t i = 0; i < pdb_infos.size(); ++i) {
+        const PDBInfo &info = pdb_infos[i];
+        int index = 0;
+        if (info.rank_kernel.is_specialized()) {
+            index = info.rank_kernel.rank_original_state(original_state);
+        } else if (info.has_value_mapping) {
+            const int *var = &variables[info.first_variable];
+            const int *multiplier = &multipliers[info.first_variable];
+            const int *value_offset = &value_offsets[info.first_variable];
+            for (int j = 0; j < info.num_variables; ++j) {
+                index += multiplier[j] * mapped_values[value_offset[j] + original_state[var[j]]];
+            }
+        } else {
+            const int *var = &variables[info.first_variable];
+            const int *multiplier = &multipliers[info.first_variable];
+            for (int j = 0; j < info.num_variables; ++j) {
+                index += multiplier[j] * original_state[var[j]];
+            }
+        }
+        state_indices[i] = index;
+        if (info.prefetch) {
+            prefetch(table_start + info.table_offset + index);
+        }
+    }
+}
+
+void PDBBank::lookup_distances(
+    const vector<int> &state_indices, vector<int> &heuristic_values) const {
+    heuristic_values.resize(pdb_infos.size());
+    const int *table_start = arena.get() + arena_start;
+    for (size_t i = 0; i < pdb_infos.size(); ++i) {
+        heuristic_values[i] = table_start[pdb_infos[i].table_offset + state_indices[i]];
+    }
+}
+
+size_t PDBBank::get_memory_usage_in_bytes() const {
+    return pdb_infos.capacity() * sizeof(PDBInfo) +
+           (variables.capacity() + multipliers.capacity() + value_offsets.capacity() +
+            mapped_values.capacity() + arena_size) * sizeof(int);
+}
+}
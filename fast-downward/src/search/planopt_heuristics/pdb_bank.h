@@ -0,0 +1,84 @@
+#ifndef PLANOPT_HEURISTICS_PDB_BANK_H
+#define PLANOPT_HEURISTICS_PDB_BANK_H
+
+#include "pdb.h"
+#include "rank_kernel.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  Stores the distance tables of a collection of PDBs in one contiguous
+  memory layout, so that looking up the heuristic values of all PDBs for a
+  state touches as few cache lines as possible:
+
+  - PDBs with small patterns are ranked with a RankKernel, the pattern
+    variables and rank multipliers of all other PDBs are stored in two
+    flat parallel arrays. The value mappings of PDBs that have one (e.g.,
+    for patterns with irrelevant variables) are concatenated in a third
+    array,
+  - all distance tables are stored in one arena, each starting at a cache
+    line boundary,
+  - the PDBs are stored in the order in which they are given. Callers
+    should sort them by table size, so small tables share cache lines.
+
+  Lookups first compute the ranks of all PDBs and prefetch the entries of
+  large tables, which overlaps the cache misses of different PDBs, and then
+  read all entries in a second loop.
+
+  The bank takes over the distance tables of the given PDBs, which can
+  afterwards only be used for their patterns and statistics. It only
+  supports PDBs with a full, uncompressed distance table.
+*/
+class PDBBank {
+    struct PDBInfo {
+        // Used instead of the arrays below if it is specialized.
+        RankKernel rank_kernel;
+        int first_variable;
+        int num_variables;
+        bool has_value_mapping;
+        std::size_t table_offset;
+        bool prefetch;
+    };
+
+    std::vector<PDBInfo> pdb_infos;
+    std::vector<int> variables;
+    std::vector<int> multipliers;
+    /*
+      For PDBs with a value mapping, the abstract value of value v of the
+      variable at position i of the arrays above is
+      mapped_values[value_offsets[i] + v].
+    */
+    std::vector<int> value_offsets;
+    std::vector<int> mapped_values;
+    struct FreeDeleter {
+        void operator()(int *data) const {
+            std::free(data);
+        }
+    };
+    // Allocated with realloc, see the constructor.
+    std::unique_ptr<int, FreeDeleter> arena;
+    // Number of entries allocated for the arena.
+    std::size_t arena_size;
+    // Offset of the first cache-line aligned entry in the arena.
+    std::size_t arena_start;
+public:
+    explicit PDBBank(std::vector<PatternDatabase> &pdbs);
+
+    static bool supports(const std::vector<PatternDatabase> &pdbs);
+
+    // Set state_indices[i] to the rank of the abstract state in the i-th PDB.
+    void compute_abstract_state_indices(
+        const TNFState &original_state, std::vector<int> &state_indices) const;
+    // Set heuristic_values[i] to the goal distance of state_indices[i].
+    void lookup_distances(
+        const std::vector<int> &state_indices, std::vector<int> &heuristic_values) const;
+
+    std::size_t get_memory_usage_in_bytes() const;
+};
+}
+
+#endif
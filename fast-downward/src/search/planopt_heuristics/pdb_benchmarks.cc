@@ -0,0 +1,187 @@
+#include "pdb_benchmarks.h"
+
+#include "canonical_pdbs.h"
+#include "pattern_hillclimbing.h"
+#include "pdb.h"
+#include "rank_kernel.h"
+#include "synthetic_tasks.h"
+
+#include "../utils/rng.h"
+#include "../utils/timer.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+
+namespace planopt_heuristics {
+static string pattern_to_json(const Pattern &pattern) {
+    ostringstream json;
+    json << "[";
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        if (i > 0)
+            json << ", ";
+        json << pattern[i];
+    }
+    json << "]";
+    return json.str();
+}
+
+static string collection_to_json(const vector<Pattern> &collection) {
+    ostringstream json;
+    json << "[";
+    for (size_t i = 0; i < collection.size(); ++i) {
+        if (i > 0)
+            json << ", ";
+        json << pattern_to_json(collection[i]);
+    }
+    json << "]";
+    return json.str();
+}
+
+void report_benchmark(
+    ostream &out, const string &task_name, const string &stage,
+    int repetitions, double seconds, const string &extra_fields) {
+    out << "{\"task\": \"" << task_name << "\", \"stage\": \"" << stage
+        << "\", \"repetitions\": " << repetitions
+        << ", \"seconds\": " << seconds
+        << ", \"seconds_per_repetition\": " << seconds / max(repetitions, 1);
+    if (!extra_fields.empty()) {
+        out << ", " << extra_fields;
+    }
+    out << "}" << endl;
+}
+
+void run_pdb_benchmarks(
+    const string &task_name, const TNFTask &task,
+    const vector<Pattern> &patterns, const BenchmarkSettings &settings,
+    ostream &out) {
+    utils::RandomNumberGenerator rng(2017);
+    vector<TNFState> states;
+    states.reserve(settings.num_lookups);
+    for (int i = 0; i < settings.num_lookups; ++i) {
+        states.push_back(create_random_tnf_state(rng, task));
+    }
+
+    for (const Pattern &pattern : patterns) {
+        string pattern_field = "\"pattern\": " + pattern_to_json(pattern);
+
+        utils::Timer projection_timer;
+        int num_abstract_operators = 0;
+        for (int i = 0; i < settings.repetitions; ++i) {
+            Projection projection(task, pattern);
+            num_abstract_operators = projection.get_projected_task().operators.size();
+        }
+        report_benchmark(out, task_name, "projection", settings.repetitions,
+                         projection_timer(),
+                         pattern_field + ", \"abstract_operators\": " +
+                         to_string(num_abstract_operators));
+
+        utils::Timer pdb_timer;
+        for (int i = 0; i < settings.repetitions - 1; ++i) {
+            PatternDatabase pdb(task, pattern);
+        }
+        PatternDatabase pdb(task, pattern);
+        report_benchmark(out, task_name, "pdb_construction", settings.repetitions,
+                         pdb_timer(), pattern_field);
+
+        /*
+          We sum up the looked up values (ignoring dead ends), so the lookups
+          cannot be optimized away. The sum also makes it easy to spot
+          changes in the heuristic values between runs.
+        */
+        long long checksum = 0;
+        utils::Timer lookup_timer;
+        for (const TNFState &state : states) {
+            int h = pdb.lookup_distance(state);
+            if (h != numeric_limits<int>::max())
+                checksum += h;
+        }
+        double lookup_time = lookup_timer();
+        report_benchmark(out, task_name, "lookup_distance", states.size(),
+                         lookup_time,
+                         pattern_field + ", \"lookups_per_second\": " +
+                         to_string(states.size() / max(lookup_time, 1e-9)) +
+                         ", \"checksum\": " + to_string(checksum));
+
+        const Projection &projection = pdb.get_projection();
+        if (RankKernel::supports(projection)) {
+            RankKernel rank_kernel(projection);
+            long long generic_checksum = 0;
+            utils::Timer generic_timer;
+            for (const TNFState &state : states) {
+                generic_checksum += projection.rank_original_state(state);
+            }
+            double generic_time = generic_timer();
+            long long kernel_checksum = 0;
+            utils::Timer kernel_timer;
+            for (const TNFState &state : states) {
+                kernel_checksum += rank_kernel.rank_original_state(state);
+            }
+            double kernel_time = kernel_timer();
+            report_benchmark(out, task_name, "rank", states.size(), kernel_time,
+                             pattern_field + ", \"generic_seconds\": " +
+                             to_string(generic_time) + ", \"checksum\": " +
+                             to_string(kernel_checksum) + ", \"generic_checksum\": " +
+                             to_string(generic_checksum));
+        }
+    }
+
+    string collection_field = "\"patterns\": " + collection_to_json(patterns);
+    utils::Timer cpdbs_construction_timer;
+    CanonicalPatternDatabases cpdbs(task, patterns);
+    report_benchmark(out, task_name, "cpdbs_construction", 1,
+                     cpdbs_construction_timer(), collection_field);
+
+    long long checksum = 0;
+    utils::Timer cpdbs_timer;
+    for (const TNFState &state : states) {
+        int h = cpdbs.compute_heuristic(state);
+        if (h != numeric_limits<int>::max())
+            checksum += h;
+    }
+    double cpdbs_time = cpdbs_timer();
+    report_benchmark(out, task_name, "cpdbs_compute_heuristic", states.size(),
+                     cpdbs_time,
+                     collection_field + ", \"evaluations_per_second\": " +
+                     to_string(states.size() / max(cpdbs_time, 1e-9)) +
+                     ", \"checksum\": " + to_string(checksum));
+
+    vector<TNFState> samples(states.begin(),
+                             states.begin() + min<size_t>(states.size(), 1000));
+    utils::Timer hillclimbing_timer;
+    vector<Pattern> collection =
+        HillClimber(task, settings.size_bound, move(samples)).run();
+    report_benchmark(out, task_name, "hillclimbing", 1, hillclimbing_timer(),
+                     "\"size_bound\": " + to_string(settings.size_bound) +
+                     ", \"patterns\": " + collection_to_json(collection));
+}
+
+static vector<Pattern> get_singleton_patterns(const TNFTask &task) {
+    vector<Pattern> patterns;
+    for (size_t var = 0; var < task.variable_domains.size(); ++var) {
+        patterns.push_back({static_cast<int>(var)});
+    }
+    return patterns;
+}
+
+void run_synthetic_pdb_benchmarks(const BenchmarkSettings &settings, ostream &out) {
+    TNFTask truck_task = create_truck_task();
+    run_pdb_benchmarks("truck", truck_task, {{0}, {0, 1}, {0, 1, 2}}, settings, out);
+
+    utils::RandomNumberGenerator rng(42);
+    for (int num_variables : {4, 8, 16}) {
+        TNFTask task = create_random_tnf_task(rng, num_variables, 6, 10 * num_variables, 3);
+        vector<Pattern> patterns = get_singleton_patterns(task);
+        // Add one pattern with (up to) four variables to get a larger table.
+        Pattern large_pattern;
+        for (int var = 0; var < min(num_variables, 4); ++var) {
+            large_pattern.push_back(var);
+        }
+        patterns.push_back(large_pattern);
+        run_pdb_benchmarks("random-" + to_string(num_variables), task,
+                           patterns, settings, out);
+    }
+}
+}
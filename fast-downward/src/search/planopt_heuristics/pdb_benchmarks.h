@@ -0,0 +1,42 @@
+#ifndef PLANOPT_HEURISTICS_PDB_BENCHMARKS_H
+#define PLANOPT_HEURISTICS_PDB_BENCHMARKS_H
+
+#include "projection.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace planopt_heuristics {
+struct BenchmarkSettings {
+    int repetitions = 5;
+    int num_lookups = 100000;
+    int size_bound = 10000;
+};
+
+/*
+  Report the time of a single benchmark as one JSON object per line, so
+  results of different runs can be collected and compared by scripts.
+  The extra fields are added verbatim and must be formatted as
+  "\"key\": value" pairs separated by commas.
+*/
+extern void report_benchmark(
+    std::ostream &out, const std::string &task_name, const std::string &stage,
+    int repetitions, double seconds, const std::string &extra_fields = "");
+
+/*
+  Time the construction of projections and PDBs for each pattern, the
+  throughput of PDB lookups and canonical heuristic evaluations on random
+  states, and a complete run of the hill climbing pattern generator.
+*/
+extern void run_pdb_benchmarks(
+    const std::string &task_name, const TNFTask &task,
+    const std::vector<Pattern> &patterns, const BenchmarkSettings &settings,
+    std::ostream &out);
+
+// Run the benchmarks on the truck task and on random tasks of growing size.
+extern void run_synthetic_pdb_benchmarks(
+    const BenchmarkSettings &settings, std::ostream &out);
+}
+
+#endif
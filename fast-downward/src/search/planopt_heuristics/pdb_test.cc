@@ -0,0 +1,444 @@
+#include "pdb_test.h"
+
+#include "canonical_pdbs.h"
+#include "pdb.h"
+#include "pdb_benchmarks.h"
+#include "post_hoc_optimization.h"
+#include "saturated_cost_partitioning.h"
+#include "synthetic_tasks.h"
+#include "zero_one_pdbs.h"
+
+#include "../algorithms/max_cliques.h"
+#include "../utils/logging.h"
+#include "../utils/rng.h"
+#include "../utils/timer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace planopt_heuristics {
+static const int NUM_STATES_PER_TASK = 200;
+static const int NUM_WALKS_PER_TASK = 20;
+static const int NUM_WALK_STEPS = 50;
+
+struct EngineMode {
+    string name;
+    PDBSettings settings;
+    // Bounded and lossy modes only have to stay below the reference.
+    bool exact;
+    // False for modes that only planopt_pdb supports.
+    bool supports_canonical;
+
+    EngineMode(const string &name, const PDBSettings &settings,
+               bool exact, bool supports_canonical)
+        : name(name),
+          settings(settings),
+          exact(exact),
+          supports_canonical(supports_canonical) {
+    }
+};
+
+static vector<EngineMode> get_engine_modes() {
+    vector<EngineMode> modes;
+    PDBSettings settings;
+    modes.emplace_back("reference", settings, true, true);
+
+    settings = PDBSettings();
+    settings.lazy = true;
+    modes.emplace_back("lazy", settings, true, true);
+
+    for (int num_threads : {2, 4}) {
+        settings = PDBSettings();
+        settings.num_threads = num_threads;
+        // The random tasks are small, so force every layer onto all threads.
+        settings.min_states_per_thread = 1;
+        modes.emplace_back("threads_" + to_string(num_threads), settings, true, true);
+    }
+
+    settings = PDBSettings();
+    settings.compression = PDBCompression::MOD3;
+    modes.emplace_back("mod3", settings, true, false);
+
+    settings = PDBSettings();
+    settings.compression = PDBCompression::SYMMETRY;
+    modes.emplace_back("symmetry", settings, true, true);
+
+    settings = PDBSettings();
+    settings.symbolic = true;
+    modes.emplace_back("symbolic", settings, true, false);
+
+    settings = PDBSettings();
+    settings.compression = PDBCompression::MIN;
+    modes.emplace_back("min", settings, false, true);
+
+    settings = PDBSettings();
+    settings.max_distance = 2;
+    modes.emplace_back("max_distance", settings, false, true);
+
+    settings = PDBSettings();
+    settings.memory_limit = 1;
+    modes.emplace_back("memory_limit", settings, false, true);
+
+    settings = PDBSettings();
+    settings.max_domain_size = 2;
+    modes.emplace_back("max_domain_size", settings, false, true);
+    return modes;
+}
+
+/*
+  Add a copy of the variable with the same domain and goal and a copy of
+  each operator that mentions it, so that the two variables are
+  interchangeable (see PatternSymmetries).
+*/
+static void add_interchangeable_variable(
+    utils::RandomNumberGenerator &rng, TNFTask &task, int var) {
+    int new_var = task.variable_domains.size();
+    task.variable_domains.push_back(task.variable_domains[var]);
+    task.initial_state.push_back(rng(task.variable_domains[var]));
+    task.goal_state.push_back(task.goal_state[var]);
+    int num_operators = task.operators.size();
+    for (int op_id = 0; op_id < num_operators; ++op_id) {
+        TNFOperator op = task.operators[op_id];
+        bool mentions_var = false;
+        for (TNFOperatorEntry &entry : op.entries) {
+            if (entry.variable_id == var) {
+                entry.variable_id = new_var;
+                mentions_var = true;
+            }
+        }
+        if (mentions_var) {
+            op.name += "_copy";
+            task.operators.push_back(move(op));
+        }
+    }
+}
+
+static vector<Pattern> create_random_patterns(
+    utils::RandomNumberGenerator &rng, const TNFTask &task) {
+    int num_variables = task.variable_domains.size();
+    vector<int> variables(num_variables);
+    for (int var = 0; var < num_variables; ++var) {
+        variables[var] = var;
+    }
+    vector<Pattern> patterns;
+    int num_patterns = 1 + rng(4);
+    for (int i = 0; i < num_patterns; ++i) {
+        // Shuffled, so the variables of a pattern are not always sorted.
+        rng.shuffle(variables);
+        int pattern_size = 1 + rng(min(num_variables, 4));
+        patterns.emplace_back(variables.begin(), variables.begin() + pattern_size);
+    }
+    return patterns;
+}
+
+static bool is_applicable(const TNFOperator &op, const TNFState &state) {
+    for (const TNFOperatorEntry &entry : op.entries) {
+        if (state[entry.variable_id] != entry.precondition_value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+  Random walk from the given state that applies the transitions of the
+  task before the TNF conversion: operators of cost 0 that change a single
+  variable (like forget operators) are applied implicitly before an
+  operator that needs them instead of on their own. Search evaluates the
+  states of such walks, and mod-3 PDBs decode each distance relative to the
+  distance of the previous state.
+*/
+static vector<TNFState> create_random_walk(
+    utils::RandomNumberGenerator &rng, const TNFTask &task, const TNFState &start) {
+    vector<set<pair<int, int>>> free_transitions(task.variable_domains.size());
+    vector<int> other_ops;
+    for (size_t op_id = 0; op_id < task.operators.size(); ++op_id) {
+        const TNFOperator &op = task.operators[op_id];
+        if (op.cost == 0 && op.entries.size() == 1) {
+            const TNFOperatorEntry &entry = op.entries[0];
+            free_transitions[entry.variable_id].emplace(
+                entry.precondition_value, entry.effect_value);
+        } else {
+            other_ops.push_back(op_id);
+        }
+    }
+
+    vector<TNFState> walk = {start};
+    for (int step = 0; step < NUM_WALK_STEPS; ++step) {
+        const TNFState &state = walk.back();
+        vector<int> applicable_ops;
+        for (int op_id : other_ops) {
+            bool applicable = true;
+            for (const TNFOperatorEntry &entry : task.operators[op_id].entries) {
+                int value = state[entry.variable_id];
+                if (value != entry.precondition_value &&
+                    !free_transitions[entry.variable_id].count(
+                        make_pair(value, entry.precondition_value))) {
+                    applicable = false;
+                    break;
+                }
+            }
+            if (applicable) {
+                applicable_ops.push_back(op_id);
+            }
+        }
+        if (applicable_ops.empty())
+            break;
+        TNFState successor = state;
+        for (const TNFOperatorEntry &entry :
+             task.operators[applicable_ops[rng(applicable_ops.size())]].entries) {
+            successor[entry.variable_id] = entry.effect_value;
+        }
+        walk.push_back(move(successor));
+    }
+    return walk;
+}
+
+static vector<PatternDatabase> build_pdbs(
+    const TNFTask &task, const vector<Pattern> &patterns, const PDBSettings &settings) {
+    vector<PatternDatabase> pdbs;
+    for (const Pattern &pattern : patterns) {
+        pdbs.emplace_back(task, pattern, settings);
+    }
+    return pdbs;
+}
+
+static bool is_consistent(const EngineMode &mode, int value, int reference_value) {
+    return mode.exact ? value == reference_value : value <= reference_value;
+}
+
+static int test_incremental_ranks(
+    utils::RandomNumberGenerator &rng, const TNFTask &task,
+    CanonicalPatternDatabases &cpdbs, int task_id) {
+    int num_mismatches = 0;
+    TNFState state = task.initial_state;
+    vector<int> indices;
+    cpdbs.compute_abstract_state_indices(state, indices);
+    for (int step = 0; step < NUM_WALK_STEPS; ++step) {
+        vector<int> applicable_ops;
+        for (size_t op_id = 0; op_id < task.operators.size(); ++op_id) {
+            if (is_applicable(task.operators[op_id], state)) {
+                applicable_ops.push_back(op_id);
+            }
+        }
+        if (applicable_ops.empty())
+            break;
+        int op_id = applicable_ops[rng(applicable_ops.size())];
+        TNFState successor = state;
+        for (const TNFOperatorEntry &entry : task.operators[op_id].entries) {
+            successor[entry.variable_id] = entry.effect_value;
+        }
+        cpdbs.update_abstract_state_indices(state, op_id, successor, indices);
+        vector<int> expected_indices;
+        cpdbs.compute_abstract_state_indices(successor, expected_indices);
+        if (indices != expected_indices) {
+            cerr << "Task " << task_id << ": incremental ranks " << indices
+                 << " of state " << successor << " should be "
+                 << expected_indices << endl;
+            ++num_mismatches;
+            indices = expected_indices;
+        }
+        state = move(successor);
+    }
+    return num_mismatches;
+}
+
+/*
+  planopt_zopdbs, planopt_scp and planopt_pho store their PDBs in a PDBBank,
+  which has to apply the value mappings of patterns with irrelevant
+  variables. The values of these variables do not matter, so setting them
+  to 0 must not change the heuristic values.
+*/
+static int test_bank_heuristics(
+    const TNFTask &task, const vector<Pattern> &patterns,
+    const vector<TNFState> &states, int task_id) {
+    ZeroOnePDBs zero_one_pdbs(task, patterns, 1);
+    SaturatedCostPartitioning scp(task, patterns, 2, task_id);
+    PostHocOptimization pho(task, patterns);
+    int num_mismatches = 0;
+    for (const TNFState &state : states) {
+        TNFState relevant_state = state;
+        for (size_t var = 0; var < state.size(); ++var) {
+            if (!task.is_relevant(var)) {
+                relevant_state[var] = 0;
+            }
+        }
+        auto check = [&](const string &name, int value, int relevant_value) {
+                if (value != relevant_value) {
+                    cerr << "Task " << task_id << ": " << name
+                         << " heuristic of patterns " << patterns << " is "
+                         << value << " for state " << state << " but "
+                         << relevant_value << " for state " << relevant_state << endl;
+                    ++num_mismatches;
+                }
+            };
+        check("zopdbs", zero_one_pdbs.compute_heuristic(state),
+              zero_one_pdbs.compute_heuristic(relevant_state));
+        check("scp", scp.compute_heuristic(state), scp.compute_heuristic(relevant_state));
+        check("pho", pho.compute_heuristic(state), pho.compute_heuristic(relevant_state));
+    }
+    return num_mismatches;
+}
+
+int test_pattern_databases(int num_tasks, int seed, ostream &out) {
+    utils::RandomNumberGenerator rng(seed);
+    vector<EngineMode> modes = get_engine_modes();
+    vector<double> pdb_times(modes.size(), 0);
+    vector<double> cpdbs_times(modes.size(), 0);
+    int num_pdbs = 0;
+    int num_mismatches = 0;
+    for (int task_id = 0; task_id < num_tasks; ++task_id) {
+        int num_variables = 2 + rng(7);
+        // Unit costs exercise the breadth-first engine for 0/1 costs.
+        int max_cost = rng(2) ? 1 : 3;
+        TNFTask task = create_random_tnf_task(
+            rng, num_variables, 5, 4 * num_variables, max_cost);
+        // Random tasks rarely have symmetries, so we add some to half of them.
+        if (rng(2)) {
+            int num_copies = 1 + rng(2);
+            for (int i = 0; i < num_copies; ++i) {
+                add_interchangeable_variable(rng, task, 0);
+            }
+        }
+        bool has_irrelevant_variables = rng(2);
+        if (has_irrelevant_variables) {
+            add_irrelevant_variables(rng, task, 1 + rng(2), 5);
+        }
+        vector<Pattern> patterns = create_random_patterns(rng, task);
+        vector<TNFState> states = {task.initial_state, task.goal_state};
+        while (static_cast<int>(states.size()) < NUM_STATES_PER_TASK) {
+            states.push_back(create_random_tnf_state(rng, task));
+        }
+
+        vector<vector<TNFState>> walks;
+        walks.push_back(create_random_walk(rng, task, task.initial_state));
+        while (static_cast<int>(walks.size()) < NUM_WALKS_PER_TASK) {
+            walks.push_back(create_random_walk(rng, task, create_random_tnf_state(rng, task)));
+        }
+
+        // reference_distances[i][j] is the distance of state j in PDB i.
+        vector<vector<int>> reference_distances;
+        for (const Pattern &pattern : patterns) {
+            PatternDatabase reference(task, pattern);
+            vector<int> distances;
+            for (const TNFState &state : states) {
+                distances.push_back(reference.lookup_distance(state));
+            }
+            vector<vector<int>> walk_distances;
+            for (const vector<TNFState> &walk : walks) {
+                walk_distances.emplace_back();
+                for (const TNFState &state : walk) {
+                    walk_distances.back().push_back(reference.lookup_distance(state));
+                }
+            }
+            for (size_t mode_id = 0; mode_id < modes.size(); ++mode_id) {
+                const EngineMode &mode = modes[mode_id];
+                utils::Timer timer;
+                PatternDatabase pdb(task, pattern, mode.settings);
+                for (size_t i = 0; i < states.size(); ++i) {
+                    int distance = pdb.lookup_distance(states[i]);
+                    if (!is_consistent(mode, distance, distances[i])) {
+                        cerr << "Task " << task_id << ", mode " << mode.name
+                             << ": pattern " << pattern << " has distance "
+                             << distance << " for state " << states[i]
+                             << " but the reference has " << distances[i]
+                             << endl;
+                        ++num_mismatches;
+                    }
+                }
+                for (size_t walk_id = 0; walk_id < walks.size(); ++walk_id) {
+                    const vector<TNFState> &walk = walks[walk_id];
+                    // Search does not evaluate the successors of dead ends.
+                    int parent_distance = pdb.lookup_distance(walk[0]);
+                    for (size_t i = 1; i < walk.size() &&
+                         parent_distance != numeric_limits<int>::max(); ++i) {
+                        int distance = pdb.lookup_distance(walk[i], parent_distance);
+                        int reference_distance = walk_distances[walk_id][i];
+                        if (!is_consistent(mode, distance, reference_distance)) {
+                            cerr << "Task " << task_id << ", mode " << mode.name
+                                 << ": pattern " << pattern << " has distance "
+                                 << distance << " for state " << walk[i]
+                                 << " after distance " << parent_distance
+                                 << " but the reference has " << reference_distance
+                                 << endl;
+                            ++num_mismatches;
+                        }
+                        parent_distance = distance;
+                    }
+                }
+                pdb_times[mode_id] += timer();
+            }
+            reference_distances.push_back(move(distances));
+            ++num_pdbs;
+        }
+
+        /*
+          The canonical reference is the maximum over all maximal additive
+          sets of the patterns, without removing redundant PDBs.
+        */
+        vector<vector<int>> maximal_additive_sets;
+        max_cliques::compute_max_cliques(
+            build_compatibility_graph(patterns, task), maximal_additive_sets);
+        vector<int> reference_values;
+        vector<int> heuristic_values(patterns.size());
+        for (size_t j = 0; j < states.size(); ++j) {
+            for (size_t i = 0; i < patterns.size(); ++i) {
+                heuristic_values[i] = reference_distances[i][j];
+            }
+            reference_values.push_back(
+                compute_max_additive_sum(maximal_additive_sets, heuristic_values));
+        }
+        for (size_t mode_id = 0; mode_id < modes.size(); ++mode_id) {
+            const EngineMode &mode = modes[mode_id];
+            if (!mode.supports_canonical)
+                continue;
+            utils::Timer timer;
+            // Test the cache with the reference settings.
+            int cache_size = (mode_id == 0) ? 64 : 0;
+            // Odd tasks test handing over PDBs that were built beforehand.
+            CanonicalPatternDatabases cpdbs = (task_id % 2) ?
+                CanonicalPatternDatabases(task, build_pdbs(task, patterns, mode.settings),
+                                          mode.settings, cache_size) :
+                CanonicalPatternDatabases(task, patterns, mode.settings, cache_size);
+            for (size_t i = 0; i < states.size(); ++i) {
+                int value = cpdbs.compute_heuristic(states[i]);
+                if (!is_consistent(mode, value, reference_values[i])) {
+                    cerr << "Task " << task_id << ", mode " << mode.name
+                         << ": canonical heuristic of patterns " << patterns
+                         << " is " << value << " for state " << states[i]
+                         << " but the reference has " << reference_values[i]
+                         << endl;
+                    ++num_mismatches;
+                }
+            }
+            cpdbs_times[mode_id] += timer();
+        }
+        CanonicalPatternDatabases cpdbs(task, patterns);
+        num_mismatches += test_incremental_ranks(rng, task, cpdbs, task_id);
+        if (has_irrelevant_variables) {
+            num_mismatches += test_bank_heuristics(task, patterns, states, task_id);
+        }
+    }
+
+    for (size_t mode_id = 0; mode_id < modes.size(); ++mode_id) {
+        const EngineMode &mode = modes[mode_id];
+        report_benchmark(out, "random", "test_pdb_" + mode.name, num_pdbs,
+                         pdb_times[mode_id]);
+        if (mode.supports_canonical) {
+            report_benchmark(out, "random", "test_cpdbs_" + mode.name, num_tasks,
+                             cpdbs_times[mode_id]);
+        }
+    }
+    g_log << "PDB differential test: " << num_tasks << " tasks, " << num_pdbs
+          << " patterns, " << modes.size() << " modes, " << num_mismatches
+          << " mismatches" << endl;
+    return num_mismatches;
+}
+}
@@ -0,0 +1,22 @@
+#ifndef PLANOPT_HEURISTICS_PDB_TEST_H
+#define PLANOPT_HEURISTICS_PDB_TEST_H
+
+#include <ostream>
+
+namespace planopt_heuristics {
+/*
+  Differential test of the PDB engines and storage modes on num_tasks
+  random TNF tasks (see create_random_tnf_task), with costs including 0
+  and forget operators. For random patterns, we build the PDB with the
+  reference settings (sequential priority-queue search into a full table)
+  and with every alternative mode, and compare their goal distances on
+  random states. We do the same for canonical heuristic values, with and
+  without a heuristic cache and with incrementally computed ranks. Exact
+  modes must match the reference. Bounded and lossy modes must not exceed
+  it. Each mismatch is printed to cerr, and the time of each mode is
+  reported with report_benchmark on out. Return the number of mismatches.
+*/
+extern int test_pattern_databases(int num_tasks, int seed, std::ostream &out);
+}
+
+#endif
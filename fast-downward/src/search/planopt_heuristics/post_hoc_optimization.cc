@@ -0,0 +1,114 @@
+#include "post_hoc_optimization.h"
+
+#include "canonical_pdbs.h"
+
+#include "../utils/logging.h"
+#include "../utils/memory.h"
+#include "../utils/timer.h"
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <set>
+
+using namespace std;
+
+namespace planopt_heuristics {
+/*
+  LP values are only exact up to rounding errors. Since all costs are
+  integers, we can round up values that are slightly below an integer.
+*/
+static const double LP_EPSILON = 1e-6;
+
+PostHocOptimization::PostHocOptimization(
+    const TNFTask &task, const vector<Pattern> &patterns)
+    : is_additive(true),
+      num_lp_solves(0) {
+    utils::Timer timer;
+    for (const Pattern &pattern : patterns) {
+        pdbs.emplace_back(task, pattern);
+    }
+    bank = utils::make_unique_ptr<PDBBank>(pdbs);
+
+    set<vector<int>> affected_pdb_sets;
+    for (const TNFOperator &op : task.operators) {
+        if (op.cost == 0)
+            continue;
+        vector<int> affected_pdbs;
+        for (size_t i = 0; i < patterns.size(); ++i) {
+            if (affects_pattern(op, patterns[i]))
+                affected_pdbs.push_back(i);
+        }
+        if (affected_pdbs.size() > 1)
+            is_additive = false;
+        if (!affected_pdbs.empty())
+            affected_pdb_sets.insert(affected_pdbs);
+    }
+    num_constraints = affected_pdb_sets.size();
+
+    if (!is_additive) {
+        vector<vector<double>> constraint_matrix;
+        for (const vector<int> &affected_pdbs : affected_pdb_sets) {
+            vector<double> row(pdbs.size(), 0);
+            for (int i : affected_pdbs)
+                row[i] = 1;
+            constraint_matrix.push_back(move(row));
+        }
+        vector<double> bounds(constraint_matrix.size(), 1);
+        solver = utils::make_unique_ptr<SimplexSolver>(constraint_matrix, bounds);
+    }
+    construction_time = timer();
+}
+
+int PostHocOptimization::compute_heuristic(const TNFState &original_state) {
+    bank->compute_abstract_state_indices(original_state, abstract_state_indices);
+    bank->lookup_distances(abstract_state_indices, heuristic_values);
+    for (int value : heuristic_values) {
+        if (value == numeric_limits<int>::max())
+            return numeric_limits<int>::max();
+    }
+
+    if (is_additive) {
+        int h = 0;
+        for (int value : heuristic_values)
+            h += value;
+        return h;
+    }
+
+    objective.assign(heuristic_values.begin(), heuristic_values.end());
+    ++num_lp_solves;
+    double value = solver->solve(objective);
+    /*
+      A PDB can only have a positive value if an operator with positive
+      cost affects it, so the LP is bounded.
+    */
+    assert(value != numeric_limits<double>::infinity());
+    return static_cast<int>(ceil(value - LP_EPSILON));
+}
+
+vector<Pattern> PostHocOptimization::get_patterns() const {
+    vector<Pattern> patterns;
+    for (const PatternDatabase &pdb : pdbs) {
+        patterns.push_back(pdb.get_pattern());
+    }
+    return patterns;
+}
+
+size_t PostHocOptimization::get_table_bytes() const {
+    return bank->get_memory_usage_in_bytes();
+}
+
+void PostHocOptimization::print_statistics() const {
+    long long num_pivots = solver ? solver->get_num_pivots() : 0;
+    double average_pivots = num_lp_solves ?
+        static_cast<double>(num_pivots) / num_lp_solves : 0;
+    g_log << "PhO statistics: pdbs=" << pdbs.size()
+          << " constraints=" << num_constraints
+          << " additive=" << (is_additive ? "yes" : "no")
+          << " table_bytes=" << get_table_bytes()
+          << " construction_time=" << construction_time << "s"
+          << " lp_solves=" << num_lp_solves
+          << " average_pivots=" << average_pivots
+          << endl;
+}
+}
@@ -0,0 +1,55 @@
+#ifndef PLANOPT_HEURISTICS_POST_HOC_OPTIMIZATION_H
+#define PLANOPT_HEURISTICS_POST_HOC_OPTIMIZATION_H
+
+#include "pdb.h"
+#include "pdb_bank.h"
+#include "simplex.h"
+
+#include <memory>
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  Post-hoc optimization heuristic over a collection of PDBs. The PhO LP
+
+      minimize sum_o X_o  subject to
+      sum_{o affects P_i} X_o >= h_i(s)  for all PDBs i,  X >= 0
+
+  (where X_o = cost(o) * Y_o is the cost spent on operator o) only changes
+  its right-hand side from state to state. We solve its dual
+
+      maximize sum_i h_i(s) w_i  subject to
+      sum_{i : o affects P_i} w_i <= 1  for all operators o,  w >= 0
+
+  instead, where the state only changes the objective. The constraints are
+  built once, and each solve starts from the previous optimal basis, which
+  stays feasible. Operators with cost 0 do not give a constraint, and
+  operators affecting the same set of PDBs give the same constraint.
+
+  If no operator affects two PDBs, the LP decomposes and its optimal value
+  is the sum of all PDB values, so we skip the LP in that case.
+*/
+class PostHocOptimization {
+    std::vector<PatternDatabase> pdbs;
+    std::unique_ptr<PDBBank> bank;
+    std::unique_ptr<SimplexSolver> solver;
+    bool is_additive;
+    int num_constraints;
+
+    std::vector<int> abstract_state_indices;
+    std::vector<int> heuristic_values;
+    std::vector<double> objective;
+    long long num_lp_solves;
+    double construction_time;
+public:
+    PostHocOptimization(const TNFTask &task, const std::vector<Pattern> &patterns);
+
+    int compute_heuristic(const TNFState &original_state);
+
+    std::vector<Pattern> get_patterns() const;
+    std::size_t get_table_bytes() const;
+    void print_statistics() const;
+};
+}
+
+#endif
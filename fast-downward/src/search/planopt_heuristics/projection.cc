@@ -1,12 +1,90 @@
 #include "projection.h"
 
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
 using namespace std;
 
 const static int NOT_PROJECTED = -1;
 
 namespace planopt_heuristics {
-Projection::Projection(const TNFTask &task, const Pattern &pattern)
-    : pattern(pattern) {
+int get_abstract_domain_size(int domain_size, int max_domain_size) {
+    return min(domain_size, max_domain_size);
+}
+
+bool has_irrelevant_variable(const TNFTask &task, const Pattern &pattern) {
+    return any_of(pattern.begin(), pattern.end(),
+                  [&](int var_id) {return !task.is_relevant(var_id); });
+}
+
+ValueMapping create_value_mapping(
+    const TNFTask &task, const Pattern &pattern, int max_domain_size) {
+    assert(max_domain_size >= 2);
+    ValueMapping value_mapping;
+    bool merges_values = false;
+    for (int var_id : pattern) {
+        int domain_size = task.variable_domains[var_id];
+        int abstract_domain_size = get_abstract_domain_size(domain_size, max_domain_size);
+        vector<int> mapping(domain_size);
+        if (!task.is_relevant(var_id)) {
+            // The values of irrelevant variables do not matter.
+            merges_values = true;
+            fill(mapping.begin(), mapping.end(), 0);
+        } else if (abstract_domain_size == domain_size) {
+            for (int value = 0; value < domain_size; ++value) {
+                mapping[value] = value;
+            }
+        } else {
+            /*
+              The goal value gets abstract value 0. The other domain_size - 1
+              values are split into abstract_domain_size - 1 blocks.
+            */
+            merges_values = true;
+            int goal_value = task.goal_state[var_id];
+            int num_other_values = domain_size - 1;
+            int other_index = 0;
+            for (int value = 0; value < domain_size; ++value) {
+                if (value == goal_value) {
+                    mapping[value] = 0;
+                } else {
+                    mapping[value] = 1 + other_index * (abstract_domain_size - 1) /
+                        num_other_values;
+                    ++other_index;
+                }
+            }
+        }
+        value_mapping.push_back(move(mapping));
+    }
+    if (!merges_values) {
+        value_mapping.clear();
+    }
+    return value_mapping;
+}
+
+vector<vector<int>> get_changed_pattern_positions(
+    const TNFTask &task, const Pattern &pattern) {
+    vector<int> positions(task.variable_domains.size(), -1);
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        positions[pattern[i]] = i;
+    }
+    vector<vector<int>> changed_positions(task.operators.size());
+    for (size_t op_id = 0; op_id < task.operators.size(); ++op_id) {
+        for (const TNFOperatorEntry &entry : task.operators[op_id].entries) {
+            int position = positions[entry.variable_id];
+            if (position != -1 && entry.precondition_value != entry.effect_value) {
+                changed_positions[op_id].push_back(position);
+            }
+        }
+    }
+    return changed_positions;
+}
+
+Projection::Projection(
+    const TNFTask &task, const Pattern &pattern, const ValueMapping &value_mapping)
+    : pattern(pattern),
+      value_mapping(value_mapping) {
+    assert(value_mapping.empty() || value_mapping.size() == pattern.size());
     /*
       Create variables and remember mapping between variables in the original
       and the projected task.
@@ -23,6 +101,10 @@ Projection::Projection(const TNFTask &task, const Pattern &pattern)
     for (int pattern_var_id : pattern) {
         variable_mapping[pattern_var_id] = var_id;
         int domain_size = task.variable_domains[pattern_var_id];
+        if (!value_mapping.empty()) {
+            const vector<int> &mapping = value_mapping[var_id];
+            domain_size = *max_element(mapping.begin(), mapping.end()) + 1;
+        }
         projected_task.variable_domains.push_back(domain_size);
         ++var_id;
     }
@@ -30,10 +112,15 @@ Projection::Projection(const TNFTask &task, const Pattern &pattern)
     /*
       Compute multipliers for ranking/unranking states.
     */
-    int multiplier = 1;
+    long long multiplier = 1;
     for (size_t i = 0; i < pattern.size(); ++i) {
         perfect_hash_multipliers.push_back(multiplier);
         multiplier *= projected_task.variable_domains[i];
+        if (multiplier > numeric_limits<int>::max()) {
+            // Ranks do not fit into an int; only symbolic PDBs work without them.
+            perfect_hash_multipliers.clear();
+            break;
+        }
     }
 
     /*
@@ -41,10 +128,8 @@ Projection::Projection(const TNFTask &task, const Pattern &pattern)
       projected_task.initial_state and projected_task.goal_state.
     */
 
-    for (auto pattern_var_id : pattern) {
-        projected_task.initial_state.push_back(task.initial_state[pattern_var_id]);
-        projected_task.goal_state.push_back(task.goal_state[pattern_var_id]);
-    }
+    projected_task.initial_state = project_state(task.initial_state);
+    projected_task.goal_state = project_state(task.goal_state);
 
     /*
       Project operators and create the projected operators in
@@ -52,23 +137,29 @@ Projection::Projection(const TNFTask &task, const Pattern &pattern)
       projection.
     */
 
-    for (auto original_operator : task.operators) {
+    for (size_t op_id = 0; op_id < task.operators.size(); ++op_id) {
+        const TNFOperator &original_operator = task.operators[op_id];
         bool has_any_changes = false; // ter mudanças = não ser no-op
         vector<TNFOperatorEntry> projected_entries;
         for (auto original_entry : original_operator.entries) {
             int projected_variable_id = variable_mapping[original_entry.variable_id];
             if (projected_variable_id == NOT_PROJECTED)
                 continue;
-            if (original_entry.effect_value != original_entry.precondition_value)
+            int precondition_value = get_abstract_value(
+                projected_variable_id, original_entry.precondition_value);
+            int effect_value = get_abstract_value(
+                projected_variable_id, original_entry.effect_value);
+            if (effect_value != precondition_value)
                 has_any_changes = true;
-            auto projected_entry = TNFOperatorEntry(projected_variable_id, 
-                                                    original_entry.precondition_value, 
-                                                    original_entry.effect_value);
+            auto projected_entry = TNFOperatorEntry(projected_variable_id,
+                                                    precondition_value,
+                                                    effect_value);
             projected_entries.push_back(projected_entry);
         }
         if (has_any_changes) {
             auto projected_operator = TNFOperator(projected_entries, original_operator.cost, original_operator.name);
             projected_task.operators.push_back(projected_operator);
+            original_operator_ids.push_back(op_id);
         }
     } 
 
@@ -78,7 +169,7 @@ TNFState Projection::project_state(const TNFState &original_state) const {
     int num_abstract_variables = pattern.size();
     TNFState abstract_state(num_abstract_variables, -1);
     for (size_t var_id = 0; var_id < pattern.size(); ++var_id) {
-        abstract_state[var_id] = original_state[pattern[var_id]];
+        abstract_state[var_id] = get_abstract_value(var_id, original_state[pattern[var_id]]);
     }
     return abstract_state;
 }
@@ -92,6 +183,19 @@ int Projection::rank_state(const TNFState &state) const {
     return index;
 }
 
+int Projection::rank_original_state(const TNFState &original_state) const {
+    int index = 0;
+    if (value_mapping.empty()) {
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            index += perfect_hash_multipliers[i] * original_state[pattern[i]];
+        }
+    } else {
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            index += perfect_hash_multipliers[i] * value_mapping[i][original_state[pattern[i]]];
+        }
+    }
+    return index;
+}
 
 TNFState Projection::unrank_state(int index) const {
     vector<int> values(pattern.size());
@@ -102,4 +206,20 @@ TNFState Projection::unrank_state(int index) const {
     assert(index == 0);
     return values;
 }
+
+size_t Projection::get_memory_usage_in_bytes() const {
+    size_t bytes = (pattern.capacity() + perfect_hash_multipliers.capacity() +
+                    original_operator_ids.capacity()) * sizeof(int);
+    for (const vector<int> &mapping : value_mapping) {
+        bytes += sizeof(mapping) + mapping.capacity() * sizeof(int);
+    }
+    bytes += (projected_task.variable_domains.capacity() +
+              projected_task.initial_state.capacity() +
+              projected_task.goal_state.capacity()) * sizeof(int);
+    bytes += projected_task.operators.capacity() * sizeof(TNFOperator);
+    for (const TNFOperator &op : projected_task.operators) {
+        bytes += op.entries.capacity() * sizeof(TNFOperatorEntry) + op.name.capacity();
+    }
+    return bytes;
+}
 }
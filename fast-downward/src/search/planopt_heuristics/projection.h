@@ -3,14 +3,50 @@
 
 #include "tnf_task.h"
 
+#include <cstddef>
 #include <vector>
 
 namespace planopt_heuristics {
 
 using Pattern = std::vector<int>;
 
+/*
+  value_mapping[i][v] is the abstract value of value v of the i-th pattern
+  variable. An empty mapping keeps all values.
+*/
+using ValueMapping = std::vector<std::vector<int>>;
+
+/*
+  Return a mapping that merges values of pattern variables with more than
+  max_domain_size values, so that each has at most max_domain_size abstract
+  values (max_domain_size >= 2). The goal value of each variable keeps an
+  abstract value of its own; all other values are grouped into blocks of
+  consecutive values. All values of variables that are irrelevant for the
+  task are merged into one. Return an empty mapping if no values are merged.
+*/
+extern ValueMapping create_value_mapping(
+    const TNFTask &task, const Pattern &pattern, int max_domain_size);
+
+extern int get_abstract_domain_size(int domain_size, int max_domain_size);
+
+// True if the pattern contains a variable that is irrelevant for the task.
+extern bool has_irrelevant_variable(const TNFTask &task, const Pattern &pattern);
+
+/*
+  Return for each operator of the task the positions (in the pattern) of
+  the pattern variables whose value the operator changes.
+*/
+extern std::vector<std::vector<int>> get_changed_pattern_positions(
+    const TNFTask &task, const Pattern &pattern);
+
+/*
+  Projection of a TNF task to a pattern, optionally combined with a domain
+  abstraction that maps the values of each pattern variable to fewer
+  abstract values. The projected task is defined over the abstract values.
+*/
 class Projection {
     Pattern pattern;
+    ValueMapping value_mapping;
 
     /*
       Multipliers for perfect hashing. In the slides, these are called N_i.
@@ -19,14 +55,59 @@ class Projection {
 
     TNFTask projected_task;
 
+    /*
+      The operator with index i in the projected task is the projection of
+      the operator with index original_operator_ids[i] in the original task.
+    */
+    std::vector<int> original_operator_ids;
+
+    int get_abstract_value(int pattern_index, int value) const {
+        return value_mapping.empty() ? value : value_mapping[pattern_index][value];
+    }
 public:
-    Projection(const TNFTask &task, const Pattern &pattern);
+    Projection(const TNFTask &task, const Pattern &pattern,
+               const ValueMapping &value_mapping = ValueMapping());
 
     TNFState project_state(const TNFState &state) const;
     int rank_state(const TNFState &state) const;
+    // Same as rank_state(project_state(original_state)) without the copy.
+    int rank_original_state(const TNFState &original_state) const;
     TNFState unrank_state(int index) const;
+    /*
+      Return rank(new_state) - rank(old_state) for two original states that
+      can only differ in the pattern variables at the given positions. The
+      states can be of any type that returns the value of a variable with
+      operator[].
+    */
+    template<typename State>
+    int get_rank_difference(const std::vector<int> &pattern_positions,
+                            const State &old_state, const State &new_state) const {
+        int difference = 0;
+        for (int position : pattern_positions) {
+            int var = pattern[position];
+            difference += perfect_hash_multipliers[position] *
+                (get_abstract_value(position, new_state[var]) -
+                 get_abstract_value(position, old_state[var]));
+        }
+        return difference;
+    }
 
-    const TNFTask &get_projected_task() { return projected_task; }
+    const TNFTask &get_projected_task() const { return projected_task; }
+    const Pattern &get_pattern() const { return pattern; }
+    bool has_value_mapping() const { return !value_mapping.empty(); }
+    const ValueMapping &get_value_mapping() const { return value_mapping; }
+    // False if the projection has too many states to rank them with an int.
+    bool can_rank_states() const {
+        return perfect_hash_multipliers.size() == pattern.size();
+    }
+    int get_original_operator_id(int projected_operator_id) const {
+        return original_operator_ids[projected_operator_id];
+    }
+    const std::vector<int> &get_perfect_hash_multipliers() const {
+        return perfect_hash_multipliers;
+    }
+    // Memory used by the pattern, the mappings and the projected task.
+    std::size_t get_memory_usage_in_bytes() const;
 
 };
 }
@@ -1,6 +1,7 @@
 #include "projection_test.h"
 
 #include "projection.h"
+#include "synthetic_tasks.h"
 #include "tnf_task.h"
 
 #include "../utils/logging.h"
@@ -116,44 +117,14 @@ void verify_tasks_match(TNFTask task, TNFTask expected) {
 }
 
 void test_projections() {
-    TNFTask task;
+    TNFTask task = create_truck_task();
     int var_package = 0;
     int var_truck_a = 1;
-    int var_truck_b = 2;
     int val_left = 0;
     int val_right = 1;
     int val_in_truck_a = 2;
     int val_in_truck_b = 3;
     int val_truck_unknown = 2;
-    task.variable_domains = {4, 3, 3};
-    task.initial_state = {val_left, val_right, val_right};
-    task.goal_state = {val_right, val_truck_unknown, val_truck_unknown};
-    task.operators = {
-        TNFOperator({{var_truck_a, val_left, val_right}}, 1, "drive_truck_a_left_right"),
-        TNFOperator({{var_truck_a, val_right, val_left}}, 1, "drive_truck_a_right_left"),
-        TNFOperator({{var_truck_b, val_left, val_right}}, 1, "drive_truck_b_left_right"),
-        TNFOperator({{var_truck_b, val_right, val_left}}, 1, "drive_truck_b_right_left"),
-        TNFOperator({{var_truck_a, val_left, val_left},
-                     {var_package, val_left, val_in_truck_a}}, 1, "load_truck_a_left"),
-        TNFOperator({{var_truck_a, val_right, val_right},
-                     {var_package, val_right, val_in_truck_a}}, 1, "load_truck_a_right"),
-        TNFOperator({{var_truck_b, val_left, val_left},
-                     {var_package, val_left, val_in_truck_b}}, 1, "load_truck_b_left"),
-        TNFOperator({{var_truck_b, val_right, val_right},
-                     {var_package, val_right, val_in_truck_b}}, 1, "load_truck_b_right"),
-        TNFOperator({{var_truck_a, val_left, val_left},
-                     {var_package, val_in_truck_a, val_left}}, 1, "unload_truck_a_left"),
-        TNFOperator({{var_truck_a, val_right, val_right},
-                     {var_package, val_in_truck_a, val_right}}, 1, "unload_truck_a_right"),
-        TNFOperator({{var_truck_b, val_left, val_left},
-                     {var_package, val_in_truck_b, val_left}}, 1, "unload_truck_b_left"),
-        TNFOperator({{var_truck_b, val_right, val_right},
-                     {var_package, val_in_truck_b, val_right}}, 1, "unload_truck_b_right"),
-        TNFOperator({{var_truck_a, val_left, val_truck_unknown}}, 0, "forget_truck_a_left"),
-        TNFOperator({{var_truck_a, val_right, val_truck_unknown}}, 0, "forget_truck_a_right"),
-        TNFOperator({{var_truck_b, val_left, val_truck_unknown}}, 0, "forget_truck_b_left"),
-        TNFOperator({{var_truck_b, val_right, val_truck_unknown}}, 0, "forget_truck_b_right"),
-    };
 
     Projection p1(task, {var_package});
     TNFTask expected1;
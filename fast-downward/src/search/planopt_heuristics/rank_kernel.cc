@@ -0,0 +1,36 @@
+#include "rank_kernel.h"
+
+#include <cassert>
+
+using namespace std;
+
+namespace planopt_heuristics {
+RankKernel::RankKernel()
+    : variables(),
+      multipliers(),
+      rank_function(nullptr) {
+}
+
+RankKernel::RankKernel(const Projection &projection)
+    : variables(),
+      multipliers(),
+      rank_function(nullptr) {
+    assert(supports(projection));
+    const Pattern &pattern = projection.get_pattern();
+    const vector<int> &pattern_multipliers = projection.get_perfect_hash_multipliers();
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        variables[i] = pattern[i];
+        multipliers[i] = pattern_multipliers[i];
+    }
+    static const RankFunction rank_functions[MAX_ARITY + 1] = {
+        rank<0>, rank<1>, rank<2>, rank<3>, rank<4>,
+        rank<5>, rank<6>, rank<7>, rank<8>
+    };
+    rank_function = rank_functions[pattern.size()];
+}
+
+bool RankKernel::supports(const Projection &projection) {
+    return static_cast<int>(projection.get_pattern().size()) <= MAX_ARITY &&
+           !projection.has_value_mapping() && projection.can_rank_states();
+}
+}
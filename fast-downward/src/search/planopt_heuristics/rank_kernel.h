@@ -0,0 +1,59 @@
+#ifndef PLANOPT_HEURISTICS_RANK_KERNEL_H
+#define PLANOPT_HEURISTICS_RANK_KERNEL_H
+
+#include "projection.h"
+
+namespace planopt_heuristics {
+/*
+  Computes the rank of the abstract state of an original state for a
+  projection with at most MAX_ARITY variables and no value mapping. The
+  pattern variables and multipliers are stored in fixed-size arrays, and the
+  constructor selects a ranking function that is specialized for the
+  number of variables, so the loop over the pattern is unrolled at compile
+  time. For singleton patterns, the rank is the value of the variable.
+
+  Projections with larger patterns or value mappings are not supported and
+  have to be ranked with Projection::rank_original_state.
+*/
+class RankKernel {
+public:
+    static const int MAX_ARITY = 8;
+private:
+    using RankFunction = int (*)(const RankKernel &kernel, const int *state);
+
+    int variables[MAX_ARITY];
+    int multipliers[MAX_ARITY];
+    RankFunction rank_function;
+
+    template<int arity>
+    static int rank(const RankKernel &kernel, const int *state) {
+        int index = 0;
+        for (int i = 0; i < arity; ++i) {
+            index += kernel.multipliers[i] * state[kernel.variables[i]];
+        }
+        return index;
+    }
+public:
+    // Create a kernel that does not support any projection.
+    RankKernel();
+    explicit RankKernel(const Projection &projection);
+
+    static bool supports(const Projection &projection);
+
+    bool is_specialized() const {
+        return rank_function != nullptr;
+    }
+
+    int rank_original_state(const TNFState &original_state) const {
+        return rank_function(*this, original_state.data());
+    }
+};
+
+// The first multiplier is 1, so the rank is the value of the variable.
+template<>
+inline int RankKernel::rank<1>(const RankKernel &kernel, const int *state) {
+    return state[kernel.variables[0]];
+}
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "saturated_cost_partitioning.h"
+
+#include "cost_partitioning.h"
+
+#include "../utils/logging.h"
+#include "../utils/memory.h"
+#include "../utils/rng.h"
+#include "../utils/timer.h"
+
+#include <cassert>
+#include <limits>
+
+using namespace std;
+
+namespace planopt_heuristics {
+SaturatedCostPartitioning::SaturatedCostPartitioning(
+    const TNFTask &task, const vector<Pattern> &patterns,
+    int num_orders, int random_seed) {
+    assert(num_orders >= 1);
+    utils::Timer timer;
+    utils::RandomNumberGenerator rng(random_seed);
+    vector<Pattern> order = patterns;
+    for (int i = 0; i < num_orders; ++i) {
+        if (i > 0) {
+            rng.shuffle(order);
+        }
+        add_order(task, order);
+    }
+    construction_time = timer();
+}
+
+void SaturatedCostPartitioning::add_order(
+    const TNFTask &task, const vector<Pattern> &order) {
+    int num_operators = task.operators.size();
+    vector<int> remaining_costs = get_operator_costs(task);
+    vector<PatternDatabase> pdbs;
+    pdbs.reserve(order.size());
+    for (const Pattern &pattern : order) {
+        pdbs.emplace_back(create_task_with_costs(task, remaining_costs), pattern);
+        vector<int> saturated_costs = pdbs.back().compute_saturated_costs(num_operators);
+        for (int op_id = 0; op_id < num_operators; ++op_id) {
+            assert(saturated_costs[op_id] <= remaining_costs[op_id]);
+            remaining_costs[op_id] -= saturated_costs[op_id];
+        }
+    }
+    banks.push_back(utils::make_unique_ptr<PDBBank>(pdbs));
+    pdbs_by_order.push_back(move(pdbs));
+}
+
+int SaturatedCostPartitioning::compute_heuristic(const TNFState &original_state) {
+    int h = 0;
+    for (const unique_ptr<PDBBank> &bank : banks) {
+        bank->compute_abstract_state_indices(original_state, abstract_state_indices);
+        bank->lookup_distances(abstract_state_indices, heuristic_values);
+        int sum = 0;
+        for (int value : heuristic_values) {
+            /*
+              Dead ends do not depend on the cost function, so an
+              infinite value in any order is a dead end.
+            */
+            if (value == numeric_limits<int>::max())
+                return numeric_limits<int>::max();
+            sum += value;
+        }
+        h = max(h, sum);
+    }
+    return h;
+}
+
+vector<Pattern> SaturatedCostPartitioning::get_patterns() const {
+    vector<Pattern> patterns;
+    for (const PatternDatabase &pdb : pdbs_by_order[0]) {
+        patterns.push_back(pdb.get_pattern());
+    }
+    return patterns;
+}
+
+size_t SaturatedCostPartitioning::get_table_bytes() const {
+    size_t table_bytes = 0;
+    for (const unique_ptr<PDBBank> &bank : banks) {
+        table_bytes += bank->get_memory_usage_in_bytes();
+    }
+    return table_bytes;
+}
+
+void SaturatedCostPartitioning::print_statistics(const TNFState &initial_state) {
+    for (size_t i = 0; i < banks.size(); ++i) {
+        banks[i]->compute_abstract_state_indices(initial_state, abstract_state_indices);
+        banks[i]->lookup_distances(abstract_state_indices, heuristic_values);
+        g_log << "SCP order " << i << ": initial_h_values=" << heuristic_values << endl;
+    }
+    g_log << "SCP statistics: orders=" << banks.size()
+          << " pdbs_per_order=" << pdbs_by_order[0].size()
+          << " table_bytes=" << get_table_bytes()
+          << " construction_time=" << construction_time << "s"
+          << endl;
+}
+}
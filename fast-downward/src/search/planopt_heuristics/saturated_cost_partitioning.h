@@ -0,0 +1,45 @@
+#ifndef PLANOPT_HEURISTICS_SATURATED_COST_PARTITIONING_H
+#define PLANOPT_HEURISTICS_SATURATED_COST_PARTITIONING_H
+
+#include "pdb.h"
+#include "pdb_bank.h"
+
+#include <memory>
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  Saturated cost partitioning over a collection of patterns. For a given
+  order of the patterns, we build the PDB of the first pattern with the
+  original operator costs, compute its saturated cost function (see
+  PatternDatabase::compute_saturated_costs), subtract it from the remaining
+  costs and continue with the next pattern and the remaining costs. The sum
+  of the resulting PDBs is admissible no matter whether the patterns are
+  additive.
+
+  With several orders, the heuristic value is the maximum over the sums of
+  all orders. The first order is the given order of the patterns, all other
+  orders are random permutations.
+*/
+class SaturatedCostPartitioning {
+    // pdbs_by_order[i] holds the PDBs of the i-th order in that order.
+    std::vector<std::vector<PatternDatabase>> pdbs_by_order;
+    std::vector<std::unique_ptr<PDBBank>> banks;
+    std::vector<int> abstract_state_indices;
+    std::vector<int> heuristic_values;
+    double construction_time;
+
+    void add_order(const TNFTask &task, const std::vector<Pattern> &order);
+public:
+    SaturatedCostPartitioning(const TNFTask &task, const std::vector<Pattern> &patterns,
+                              int num_orders, int random_seed);
+
+    int compute_heuristic(const TNFState &original_state);
+
+    std::vector<Pattern> get_patterns() const;
+    std::size_t get_table_bytes() const;
+    void print_statistics(const TNFState &initial_state);
+};
+}
+
+#endif
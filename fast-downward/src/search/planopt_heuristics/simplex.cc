@@ -0,0 +1,143 @@
+#include "simplex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+using namespace std;
+
+namespace planopt_heuristics {
+static const double EPSILON = 1e-9;
+
+SimplexSolver::SimplexSolver(
+    const vector<vector<double>> &constraint_matrix, const vector<double> &bounds)
+    : num_variables(constraint_matrix.empty() ? 0 : constraint_matrix[0].size()),
+      num_constraints(constraint_matrix.size()),
+      rows(constraint_matrix),
+      rhs(bounds),
+      objective(num_variables, 0),
+      num_pivots(0) {
+    assert(bounds.size() == constraint_matrix.size());
+    for (int r = 0; r < num_constraints; ++r) {
+        assert(rhs[r] >= 0);
+        basic_variables.push_back(num_variables + r);
+    }
+    for (int k = 0; k < num_variables; ++k) {
+        nonbasic_variables.push_back(k);
+    }
+}
+
+void SimplexSolver::compute_reduced_costs() {
+    /*
+      The objective in terms of the nonbasic variables is obtained by
+      substituting the rows of all basic structural variables.
+    */
+    reduced_costs.assign(num_variables, 0);
+    for (int k = 0; k < num_variables; ++k) {
+        int var = nonbasic_variables[k];
+        if (var < num_variables) {
+            reduced_costs[k] = objective[var];
+        }
+    }
+    for (int r = 0; r < num_constraints; ++r) {
+        int var = basic_variables[r];
+        if (var < num_variables && objective[var] != 0) {
+            double coefficient = objective[var];
+            const vector<double> &row = rows[r];
+            for (int k = 0; k < num_variables; ++k) {
+                reduced_costs[k] -= coefficient * row[k];
+            }
+        }
+    }
+}
+
+void SimplexSolver::pivot(int pivot_row, int pivot_column) {
+    ++num_pivots;
+    vector<double> &row = rows[pivot_row];
+    double pivot_element = row[pivot_column];
+    assert(pivot_element > EPSILON);
+
+    // Solve the pivot row for the entering variable.
+    rhs[pivot_row] /= pivot_element;
+    for (int k = 0; k < num_variables; ++k) {
+        if (k != pivot_column)
+            row[k] /= pivot_element;
+    }
+    row[pivot_column] = 1 / pivot_element;
+
+    // Substitute the entering variable in all other rows.
+    for (int r = 0; r < num_constraints; ++r) {
+        if (r == pivot_row)
+            continue;
+        vector<double> &other = rows[r];
+        double factor = other[pivot_column];
+        if (factor == 0)
+            continue;
+        rhs[r] -= factor * rhs[pivot_row];
+        for (int k = 0; k < num_variables; ++k) {
+            if (k != pivot_column)
+                other[k] -= factor * row[k];
+        }
+        other[pivot_column] = -factor * row[pivot_column];
+        // Avoid slightly negative values caused by rounding errors.
+        if (rhs[r] < 0)
+            rhs[r] = 0;
+    }
+
+    double factor = reduced_costs[pivot_column];
+    for (int k = 0; k < num_variables; ++k) {
+        if (k != pivot_column)
+            reduced_costs[k] -= factor * row[k];
+    }
+    reduced_costs[pivot_column] = -factor * row[pivot_column];
+
+    swap(basic_variables[pivot_row], nonbasic_variables[pivot_column]);
+}
+
+double SimplexSolver::solve(const vector<double> &objective_coefficients) {
+    assert(static_cast<int>(objective_coefficients.size()) == num_variables);
+    objective = objective_coefficients;
+    compute_reduced_costs();
+
+    while (true) {
+        // Bland's rule: entering variable with the smallest index.
+        int pivot_column = -1;
+        for (int k = 0; k < num_variables; ++k) {
+            if (reduced_costs[k] > EPSILON &&
+                (pivot_column == -1 ||
+                 nonbasic_variables[k] < nonbasic_variables[pivot_column])) {
+                pivot_column = k;
+            }
+        }
+        if (pivot_column == -1)
+            break;
+
+        // Ratio test, ties broken by the smallest variable index.
+        int pivot_row = -1;
+        double min_ratio = 0;
+        for (int r = 0; r < num_constraints; ++r) {
+            double coefficient = rows[r][pivot_column];
+            if (coefficient <= EPSILON)
+                continue;
+            double ratio = rhs[r] / coefficient;
+            if (pivot_row == -1 || ratio < min_ratio - EPSILON ||
+                (ratio < min_ratio + EPSILON &&
+                 basic_variables[r] < basic_variables[pivot_row])) {
+                pivot_row = r;
+                min_ratio = ratio;
+            }
+        }
+        if (pivot_row == -1)
+            return numeric_limits<double>::infinity();
+        pivot(pivot_row, pivot_column);
+    }
+
+    double value = 0;
+    for (int r = 0; r < num_constraints; ++r) {
+        int var = basic_variables[r];
+        if (var < num_variables)
+            value += objective[var] * rhs[r];
+    }
+    return value;
+}
+}
@@ -0,0 +1,55 @@
+#ifndef PLANOPT_HEURISTICS_SIMPLEX_H
+#define PLANOPT_HEURISTICS_SIMPLEX_H
+
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  Small dense simplex solver for linear programs of the form
+
+      maximize c^T x  subject to  A x <= b,  x >= 0
+
+  where b >= 0, so the basis of slack variables is a feasible starting
+  point and no phase one is needed. The constraints are fixed on
+  construction, while the objective can change between calls to solve().
+  Since the feasibility of a basis does not depend on the objective, every
+  call starts from the optimal basis of the previous call (warm start),
+  which usually only needs a few pivots if the objectives are similar.
+
+  We store the LP as a dictionary: one row for each basic variable that
+  expresses it in terms of the nonbasic variables. Variables 0..n-1 are the
+  structural variables and n..n+m-1 the slack variables. We use Bland's
+  rule, so the solver cannot cycle.
+*/
+class SimplexSolver {
+    int num_variables;
+    int num_constraints;
+    // rows[r][k] is the coefficient a_rk in x_B(r) = rhs[r] - sum_k a_rk x_N(k).
+    std::vector<std::vector<double>> rows;
+    std::vector<double> rhs;
+    std::vector<int> basic_variables;
+    std::vector<int> nonbasic_variables;
+    std::vector<double> objective;
+    // Reduced costs of the nonbasic variables.
+    std::vector<double> reduced_costs;
+    long long num_pivots;
+
+    void compute_reduced_costs();
+    void pivot(int row, int column);
+public:
+    SimplexSolver(const std::vector<std::vector<double>> &constraint_matrix,
+                  const std::vector<double> &bounds);
+
+    /*
+      Return the optimal objective value for the given objective
+      coefficients or infinity if the LP is unbounded.
+    */
+    double solve(const std::vector<double> &objective_coefficients);
+
+    long long get_num_pivots() const {
+        return num_pivots;
+    }
+};
+}
+
+#endif
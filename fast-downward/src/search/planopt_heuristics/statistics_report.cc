@@ -0,0 +1,81 @@
+#include "statistics_report.h"
+
+#include "../option_parser.h"
+
+#include "../utils/system.h"
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+
+namespace planopt_heuristics {
+static const char *STATISTICS_FILE = "planopt_statistics.jsonl";
+
+StatisticsReport::StatisticsReport(
+    const options::Options &opts, const string &heuristic_name)
+    : enabled(opts.get<bool>("write_statistics")),
+      heuristic_name(heuristic_name),
+      num_evaluations(0),
+      num_dead_ends(0) {
+}
+
+void StatisticsReport::write_record(const string &fields) const {
+    ofstream file(STATISTICS_FILE, ios::app);
+    file << "{\"heuristic\": \"" << heuristic_name << "\", " << fields
+         << ", \"peak_memory_kb\": " << utils::get_peak_memory_in_kb()
+         << "}" << endl;
+}
+
+void StatisticsReport::report_construction(
+    const vector<Pattern> &patterns, double construction_time,
+    size_t table_bytes, int initial_h) {
+    if (!enabled)
+        return;
+    ostringstream fields;
+    fields << "\"patterns\": [";
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        if (i > 0)
+            fields << ", ";
+        fields << "[";
+        for (size_t j = 0; j < patterns[i].size(); ++j) {
+            if (j > 0)
+                fields << ", ";
+            fields << patterns[i][j];
+        }
+        fields << "]";
+    }
+    fields << "], \"construction_time\": " << construction_time
+           << ", \"table_bytes\": " << table_bytes
+           << ", \"initial_h\": ";
+    if (initial_h == numeric_limits<int>::max()) {
+        fields << "null";
+    } else {
+        fields << initial_h;
+    }
+    construction_fields = fields.str();
+    write_record(construction_fields + ", \"evaluations\": 0, \"dead_ends\": 0");
+}
+
+void StatisticsReport::report_evaluation(int h) {
+    if (!enabled)
+        return;
+    ++num_evaluations;
+    if (h == numeric_limits<int>::max()) {
+        ++num_dead_ends;
+    }
+    if ((num_evaluations & (num_evaluations - 1)) == 0) {
+        write_record(construction_fields +
+                     ", \"evaluations\": " + to_string(num_evaluations) +
+                     ", \"dead_ends\": " + to_string(num_dead_ends));
+    }
+}
+
+void add_statistics_report_options_to_parser(options::OptionParser &parser) {
+    parser.add_option<bool>(
+        "write_statistics",
+        "append statistics records (JSON lines) to planopt_statistics.jsonl",
+        "false");
+}
+}
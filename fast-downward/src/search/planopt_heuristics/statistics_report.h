@@ -0,0 +1,45 @@
+#ifndef PLANOPT_HEURISTICS_STATISTICS_REPORT_H
+#define PLANOPT_HEURISTICS_STATISTICS_REPORT_H
+
+#include "projection.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace options {
+class OptionParser;
+class Options;
+}
+
+namespace planopt_heuristics {
+/*
+  Writes machine-readable statistics of a planopt heuristic as JSON lines to
+  the file planopt_statistics.jsonl in the working directory (if enabled
+  with the option write_statistics). The first record describes the
+  construction of the heuristic. Since a run can be killed at any time, we
+  write a new record with the current number of evaluations and dead ends
+  whenever the number of evaluations reaches a power of two. The last
+  record in the file is the most recent one.
+*/
+class StatisticsReport {
+    bool enabled;
+    std::string heuristic_name;
+    std::string construction_fields;
+    long long num_evaluations;
+    long long num_dead_ends;
+
+    void write_record(const std::string &fields) const;
+public:
+    StatisticsReport(const options::Options &opts, const std::string &heuristic_name);
+
+    void report_construction(
+        const std::vector<Pattern> &patterns, double construction_time,
+        std::size_t table_bytes, int initial_h);
+    void report_evaluation(int h);
+};
+
+extern void add_statistics_report_options_to_parser(options::OptionParser &parser);
+}
+
+#endif
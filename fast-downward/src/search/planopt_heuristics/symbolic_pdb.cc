@@ -0,0 +1,155 @@
+#include "symbolic_pdb.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <map>
+
+using namespace std;
+
+namespace planopt_heuristics {
+/*
+  We collect garbage whenever the number of BDD nodes has grown by this
+  factor since the last collection.
+*/
+static const size_t GARBAGE_COLLECTION_FACTOR = 2;
+static const size_t MIN_NODES_FOR_GARBAGE_COLLECTION = 1 << 16;
+
+static int get_num_bits(int domain_size) {
+    int bits = 0;
+    while ((1 << bits) < domain_size)
+        ++bits;
+    return bits;
+}
+
+static int count_bits(const vector<int> &domains, vector<int> &first_bits,
+                      vector<int> &num_bits) {
+    int total = 0;
+    for (int domain_size : domains) {
+        first_bits.push_back(total);
+        num_bits.push_back(get_num_bits(domain_size));
+        total += num_bits.back();
+    }
+    return total;
+}
+
+SymbolicSearch::SymbolicSearch(const TNFTask &task)
+    : num_bdd_variables(count_bits(task.variable_domains, first_bits, num_bits)),
+      manager(num_bdd_variables),
+      reachable(BDDManager::FALSE_BDD),
+      peak_nodes(0) {
+    for (const TNFOperator &op : task.operators) {
+        vector<pair<int, int>> preconditions;
+        vector<pair<int, int>> effects;
+        for (const TNFOperatorEntry &entry : op.entries) {
+            preconditions.emplace_back(entry.variable_id, entry.precondition_value);
+            effects.emplace_back(entry.variable_id, entry.effect_value);
+        }
+        SymbolicOperator symbolic_op;
+        symbolic_op.cost = op.cost;
+        symbolic_op.effect_values = encode_partial_state(effects);
+        symbolic_op.precondition = manager.make_cube(encode_partial_state(preconditions));
+        operators.push_back(move(symbolic_op));
+    }
+    search(task.goal_state);
+}
+
+vector<int> SymbolicSearch::encode_partial_state(
+    const vector<pair<int, int>> &facts) const {
+    vector<int> bit_values(num_bdd_variables, -1);
+    for (const pair<int, int> &fact : facts) {
+        int var = fact.first;
+        int value = fact.second;
+        // The most significant bit comes first.
+        for (int bit = 0; bit < num_bits[var]; ++bit) {
+            bit_values[first_bits[var] + bit] = (value >> (num_bits[var] - 1 - bit)) & 1;
+        }
+    }
+    return bit_values;
+}
+
+vector<int> SymbolicSearch::encode_state(const TNFState &state) const {
+    vector<pair<int, int>> facts;
+    for (size_t var = 0; var < state.size(); ++var) {
+        facts.emplace_back(var, state[var]);
+    }
+    return encode_partial_state(facts);
+}
+
+BDD SymbolicSearch::compute_preimage(const SymbolicOperator &op, BDD states) {
+    BDD restricted = manager.restrict(states, op.effect_values);
+    return manager.bdd_and(restricted, op.precondition);
+}
+
+void SymbolicSearch::search(const TNFState &goal_state) {
+    // Maps a goal distance to the states that can reach the goal with this cost.
+    map<int, BDD> open;
+    open[0] = manager.make_cube(encode_state(goal_state));
+    size_t nodes_after_last_collection = manager.get_num_nodes();
+
+    while (!open.empty()) {
+        int distance = open.begin()->first;
+        BDD layer = manager.bdd_and_not(open.begin()->second, reachable);
+        open.erase(open.begin());
+        if (layer == BDDManager::FALSE_BDD)
+            continue;
+
+        // Add all states that reach the layer with cost 0.
+        BDD frontier = layer;
+        while (frontier != BDDManager::FALSE_BDD) {
+            BDD new_states = BDDManager::FALSE_BDD;
+            for (const SymbolicOperator &op : operators) {
+                if (op.cost == 0) {
+                    new_states = manager.bdd_or(new_states, compute_preimage(op, frontier));
+                }
+            }
+            new_states = manager.bdd_and_not(new_states, layer);
+            frontier = manager.bdd_and_not(new_states, reachable);
+            layer = manager.bdd_or(layer, frontier);
+        }
+        reachable = manager.bdd_or(reachable, layer);
+        layers.emplace_back(distance, layer);
+
+        for (const SymbolicOperator &op : operators) {
+            if (op.cost == 0)
+                continue;
+            BDD preimage = manager.bdd_and_not(compute_preimage(op, layer), reachable);
+            if (preimage == BDDManager::FALSE_BDD)
+                continue;
+            auto it = open.find(distance + op.cost);
+            if (it == open.end()) {
+                open[distance + op.cost] = preimage;
+            } else {
+                it->second = manager.bdd_or(it->second, preimage);
+            }
+        }
+
+        peak_nodes = max(peak_nodes, manager.get_num_nodes());
+        if (manager.get_num_nodes() >= MIN_NODES_FOR_GARBAGE_COLLECTION &&
+            manager.get_num_nodes() >= GARBAGE_COLLECTION_FACTOR * nodes_after_last_collection) {
+            vector<BDD *> roots = {&reachable};
+            for (SymbolicOperator &op : operators)
+                roots.push_back(&op.precondition);
+            for (pair<const int, BDD> &entry : open)
+                roots.push_back(&entry.second);
+            for (pair<int, BDD> &entry : layers)
+                roots.push_back(&entry.second);
+            manager.collect_garbage(roots);
+            nodes_after_last_collection = manager.get_num_nodes();
+        }
+    }
+    peak_nodes = max(peak_nodes, manager.get_num_nodes());
+}
+
+int SymbolicSearch::lookup_distance(const TNFState &abstract_state) const {
+    vector<int> assignment = encode_state(abstract_state);
+    if (!manager.evaluate(reachable, assignment))
+        return numeric_limits<int>::max();
+    for (const pair<int, BDD> &layer : layers) {
+        if (manager.evaluate(layer.second, assignment))
+            return layer.first;
+    }
+    assert(false);
+    return numeric_limits<int>::max();
+}
+}
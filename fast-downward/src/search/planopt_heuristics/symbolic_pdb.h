@@ -0,0 +1,70 @@
+#ifndef PLANOPT_HEURISTICS_SYMBOLIC_PDB_H
+#define PLANOPT_HEURISTICS_SYMBOLIC_PDB_H
+
+#include "bdd.h"
+#include "tnf_task.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  Goal distances of all states of a (projected) TNF task, computed by a
+  symbolic backward uniform cost search. Sets of abstract states are BDDs
+  over a binary encoding of the variables (ceil(log2(k)) bits for a
+  variable with k values, most significant bit first, variables in order).
+
+  The search expands all states with goal distance g at once. Since the
+  task is in TNF, the preimage of a set S under an operator with entries
+  (v, p, e) is the relational product of S with the transition relation of
+  the operator, which simplifies to (S restricted to v = e) and (v = p).
+  We first close each layer under operators with cost 0 and then add the
+  preimages under all other operators to the layers g + cost.
+
+  The result is a list of layers (g, states with goal distance g) in
+  increasing order of g. Unlike an explicit table, this does not need
+  memory proportional to the number of abstract states, so it also works
+  for projections whose states cannot be ranked with an int.
+*/
+class SymbolicSearch {
+    struct SymbolicOperator {
+        int cost;
+        // Bit values for each BDD variable or -1 if the operator does not mention it.
+        std::vector<int> effect_values;
+        BDD precondition;
+    };
+
+    // The first BDD variable of each task variable and its number of bits.
+    std::vector<int> first_bits;
+    std::vector<int> num_bits;
+    int num_bdd_variables;
+    BDDManager manager;
+    std::vector<SymbolicOperator> operators;
+    BDD reachable;
+    std::vector<std::pair<int, BDD>> layers;
+    std::size_t peak_nodes;
+
+    std::vector<int> encode_partial_state(
+        const std::vector<std::pair<int, int>> &facts) const;
+    std::vector<int> encode_state(const TNFState &state) const;
+    BDD compute_preimage(const SymbolicOperator &op, BDD states);
+    void search(const TNFState &goal_state);
+public:
+    explicit SymbolicSearch(const TNFTask &task);
+
+    int lookup_distance(const TNFState &abstract_state) const;
+
+    int get_num_layers() const {
+        return layers.size();
+    }
+    std::size_t get_peak_nodes() const {
+        return peak_nodes;
+    }
+    std::size_t get_memory_usage_in_bytes() const {
+        return manager.get_memory_usage_in_bytes();
+    }
+};
+}
+
+#endif
@@ -0,0 +1,144 @@
+#include "synthetic_tasks.h"
+
+#include "../utils/rng.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace std;
+
+namespace planopt_heuristics {
+TNFTask create_truck_task() {
+    TNFTask task;
+    int var_package = 0;
+    int var_truck_a = 1;
+    int var_truck_b = 2;
+    int val_left = 0;
+    int val_right = 1;
+    int val_in_truck_a = 2;
+    int val_in_truck_b = 3;
+    int val_truck_unknown = 2;
+    task.variable_domains = {4, 3, 3};
+    task.initial_state = {val_left, val_right, val_right};
+    task.goal_state = {val_right, val_truck_unknown, val_truck_unknown};
+    task.operators = {
+        TNFOperator({{var_truck_a, val_left, val_right}}, 1, "drive_truck_a_left_right"),
+        TNFOperator({{var_truck_a, val_right, val_left}}, 1, "drive_truck_a_right_left"),
+        TNFOperator({{var_truck_b, val_left, val_right}}, 1, "drive_truck_b_left_right"),
+        TNFOperator({{var_truck_b, val_right, val_left}}, 1, "drive_truck_b_right_left"),
+        TNFOperator({{var_truck_a, val_left, val_left},
+                     {var_package, val_left, val_in_truck_a}}, 1, "load_truck_a_left"),
+        TNFOperator({{var_truck_a, val_right, val_right},
+                     {var_package, val_right, val_in_truck_a}}, 1, "load_truck_a_right"),
+        TNFOperator({{var_truck_b, val_left, val_left},
+                     {var_package, val_left, val_in_truck_b}}, 1, "load_truck_b_left"),
+        TNFOperator({{var_truck_b, val_right, val_right},
+                     {var_package, val_right, val_in_truck_b}}, 1, "load_truck_b_right"),
+        TNFOperator({{var_truck_a, val_left, val_left},
+                     {var_package, val_in_truck_a, val_left}}, 1, "unload_truck_a_left"),
+        TNFOperator({{var_truck_a, val_right, val_right},
+                     {var_package, val_in_truck_a, val_right}}, 1, "unload_truck_a_right"),
+        TNFOperator({{var_truck_b, val_left, val_left},
+                     {var_package, val_in_truck_b, val_left}}, 1, "unload_truck_b_left"),
+        TNFOperator({{var_truck_b, val_right, val_right},
+                     {var_package, val_in_truck_b, val_right}}, 1, "unload_truck_b_right"),
+        TNFOperator({{var_truck_a, val_left, val_truck_unknown}}, 0, "forget_truck_a_left"),
+        TNFOperator({{var_truck_a, val_right, val_truck_unknown}}, 0, "forget_truck_a_right"),
+        TNFOperator({{var_truck_b, val_left, val_truck_unknown}}, 0, "forget_truck_b_left"),
+        TNFOperator({{var_truck_b, val_right, val_truck_unknown}}, 0, "forget_truck_b_right"),
+    };
+    return task;
+}
+
+TNFTask create_random_tnf_task(
+    utils::RandomNumberGenerator &rng, int num_variables, int max_domain_size,
+    int num_operators, int max_cost) {
+    TNFTask task;
+    /*
+      Values below known_domain_sizes[var] are regular values. If a variable
+      has an "unknown" value, it is the last value of its domain.
+    */
+    vector<int> known_domain_sizes;
+    for (int var = 0; var < num_variables; ++var) {
+        int domain_size = 2 + rng(max(max_domain_size - 1, 1));
+        known_domain_sizes.push_back(domain_size);
+        task.initial_state.push_back(rng(domain_size));
+        if (rng(2) == 0) {
+            task.variable_domains.push_back(domain_size + 1);
+            task.goal_state.push_back(rng(2) ? domain_size : rng(domain_size));
+        } else {
+            task.variable_domains.push_back(domain_size);
+            task.goal_state.push_back(rng(domain_size));
+        }
+    }
+
+    for (int op_id = 0; op_id < num_operators; ++op_id) {
+        vector<int> variables(num_variables);
+        for (int var = 0; var < num_variables; ++var) {
+            variables[var] = var;
+        }
+        rng.shuffle(variables);
+        int num_entries = 1 + rng(min(num_variables, 3));
+        vector<TNFOperatorEntry> entries;
+        for (int i = 0; i < num_entries; ++i) {
+            int var = variables[i];
+            int unknown_value = known_domain_sizes[var];
+            if (task.variable_domains[var] > unknown_value && rng(3) == 0) {
+                /*
+                  Effect without precondition: the operator needs the
+                  "unknown" value, which the forget operators reach.
+                */
+                entries.emplace_back(var, unknown_value, rng(unknown_value));
+                continue;
+            }
+            int pre = rng(unknown_value);
+            // The first entry always changes its variable.
+            int eff = pre;
+            if (i == 0) {
+                eff = (pre + 1 + rng(unknown_value - 1)) % unknown_value;
+            } else if (rng(2) == 0) {
+                eff = rng(unknown_value);
+            }
+            entries.emplace_back(var, pre, eff);
+        }
+        task.operators.emplace_back(entries, rng(max_cost + 1), "op" + to_string(op_id));
+    }
+
+    for (int var = 0; var < num_variables; ++var) {
+        int unknown_value = known_domain_sizes[var];
+        if (task.variable_domains[var] > unknown_value) {
+            for (int value = 0; value < unknown_value; ++value) {
+                string name = "forget_" + to_string(var) + "_" + to_string(value);
+                task.operators.emplace_back(
+                    vector<TNFOperatorEntry>{TNFOperatorEntry(var, value, unknown_value)},
+                    0, name);
+            }
+        }
+    }
+    return task;
+}
+
+void add_irrelevant_variables(
+    utils::RandomNumberGenerator &rng, TNFTask &task, int num_variables,
+    int max_domain_size) {
+    task.irrelevant_variables.resize(task.variable_domains.size(), false);
+    for (int i = 0; i < num_variables; ++i) {
+        int domain_size = 2 + rng(max(max_domain_size - 1, 1));
+        task.variable_domains.push_back(domain_size);
+        task.initial_state.push_back(rng(domain_size));
+        // Like create_tnf_task, use the initial value as the goal.
+        task.goal_state.push_back(task.initial_state.back());
+        task.irrelevant_variables.push_back(true);
+    }
+}
+
+TNFState create_random_tnf_state(
+    utils::RandomNumberGenerator &rng, const TNFTask &task) {
+    TNFState state;
+    state.reserve(task.variable_domains.size());
+    for (int domain_size : task.variable_domains) {
+        state.push_back(rng(domain_size));
+    }
+    return state;
+}
+}
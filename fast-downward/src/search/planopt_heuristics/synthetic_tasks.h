@@ -0,0 +1,46 @@
+#ifndef PLANOPT_HEURISTICS_SYNTHETIC_TASKS_H
+#define PLANOPT_HEURISTICS_SYNTHETIC_TASKS_H
+
+#include "tnf_task.h"
+
+namespace utils {
+class RandomNumberGenerator;
+}
+
+namespace planopt_heuristics {
+/*
+  Small logistics task with one package and two trucks that can drive between
+  two locations (left and right). The package has to end up at the right
+  location. The trucks are not mentioned in the goal, so they have an
+  "unknown" value and forget operators.
+*/
+extern TNFTask create_truck_task();
+
+/*
+  Random task in TNF with num_variables variables with 2 to max_domain_size
+  values each and num_operators operators with costs between 0 and
+  max_cost. About half of the variables get an "unknown" value and forget
+  operators (with cost 0) like variables of a converted SAS task that are
+  not mentioned in the goal or that some operator changes without a
+  precondition. The "unknown" value is the goal value of half of them.
+  Operators can require the "unknown" value, like SAS operators with an
+  effect on a variable without precondition.
+*/
+extern TNFTask create_random_tnf_task(
+    utils::RandomNumberGenerator &rng, int num_variables, int max_domain_size,
+    int num_operators, int max_cost);
+
+/*
+  Add num_variables variables that no operator mentions and mark them as
+  irrelevant, like the relevance analysis of create_tnf_task does.
+*/
+extern void add_irrelevant_variables(
+    utils::RandomNumberGenerator &rng, TNFTask &task, int num_variables,
+    int max_domain_size);
+
+// Random state of the given task (which may include "unknown" values).
+extern TNFState create_random_tnf_state(
+    utils::RandomNumberGenerator &rng, const TNFTask &task);
+}
+
+#endif
@@ -1,7 +1,9 @@
 #include "tnf_task.h"
 
 #include "../task_utils/task_properties.h"
+#include "../utils/logging.h"
 
+#include <algorithm>
 
 using namespace std;
 
@@ -10,9 +12,43 @@ static int get_unknown_value(const VariableProxy &variable) {
     return variable.get_domain_size();
 }
 
+static vector<bool> compute_relevant_variables(const TaskProxy &sas_task) {
+    /*
+      A variable is relevant if it occurs in the goal or in a precondition
+      of an operator that has an effect on a relevant variable.
+    */
+    vector<bool> relevant(sas_task.get_variables().size(), false);
+    for (FactProxy goal : sas_task.get_goals()) {
+        relevant[goal.get_variable().get_id()] = true;
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (OperatorProxy op : sas_task.get_operators()) {
+            bool affects_relevant_variable = false;
+            for (EffectProxy effect : op.get_effects()) {
+                if (relevant[effect.get_fact().get_variable().get_id()]) {
+                    affects_relevant_variable = true;
+                    break;
+                }
+            }
+            if (!affects_relevant_variable)
+                continue;
+            for (FactProxy precondition : op.get_preconditions()) {
+                int var_id = precondition.get_variable().get_id();
+                if (!relevant[var_id]) {
+                    relevant[var_id] = true;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return relevant;
+}
+
 static TNFOperator create_tnf_operator(
     const OperatorProxy &op, const VariablesProxy &variables,
-    vector<bool> &unknown_fact_needed) {
+    const vector<bool> &relevant, vector<bool> &unknown_fact_needed) {
     int num_vars = variables.size();
 
     vector<int> precondition_values(num_vars, -1);
@@ -27,11 +63,25 @@ static TNFOperator create_tnf_operator(
         effect_values[fact.var] = fact.value;
     }
 
-    vector<TNFOperatorEntry> entries;
+    /*
+      An operator without an effect on a relevant variable can never be
+      part of a plan that matters for the goal. We keep it without entries,
+      so that operator ids stay the same. All its preconditions are on
+      relevant variables otherwise, so the only entries of irrelevant
+      variables we drop are effects.
+    */
+    bool affects_relevant_variable = false;
     for (int var_id = 0; var_id < num_vars; ++var_id) {
+        if (relevant[var_id] && effect_values[var_id] != -1) {
+            affects_relevant_variable = true;
+        }
+    }
+
+    vector<TNFOperatorEntry> entries;
+    for (int var_id = 0; var_id < num_vars && affects_relevant_variable; ++var_id) {
         int pre_value = precondition_values[var_id];
         int post_value = effect_values[var_id];
-        if (pre_value == -1 && post_value == -1) {
+        if (!relevant[var_id] || (pre_value == -1 && post_value == -1)) {
             continue;
         } else if (pre_value == -1) {
             unknown_fact_needed[var_id] = true;
@@ -52,6 +102,7 @@ TNFTask create_tnf_task(const TaskProxy &sas_task) {
     int num_sas_variables = sas_variables.size();
 
     TNFTask tnf_task;
+    vector<bool> relevant = compute_relevant_variables(sas_task);
 
     /*
       We add an "unknown" fact for variables occuring in effects, but
@@ -66,7 +117,8 @@ TNFTask create_tnf_task(const TaskProxy &sas_task) {
     */
     tnf_task.operators.reserve(sas_operators.size());
     for (OperatorProxy op : sas_operators) {
-        TNFOperator tnf_op = create_tnf_operator(op, sas_variables, unknown_fact_needed);
+        TNFOperator tnf_op = create_tnf_operator(
+            op, sas_variables, relevant, unknown_fact_needed);
         tnf_task.operators.push_back(tnf_op);
     }
 
@@ -91,9 +143,17 @@ TNFTask create_tnf_task(const TaskProxy &sas_task) {
     }
     for (size_t var_id = 0; var_id < tnf_task.goal_state.size(); ++var_id) {
         int goal_value = tnf_task.goal_state[var_id];
-        if (goal_value == get_unknown_value(sas_variables[var_id])) {
+        if (goal_value != get_unknown_value(sas_variables[var_id])) {
+            continue;
+        } else if (relevant[var_id]) {
             // Variables missing in goal description need an "unknown" fact.
             unknown_fact_needed[var_id] = true;
+        } else {
+            /*
+              Projections ignore the values of irrelevant variables, so any
+              value works as their goal and they need no forget operators.
+            */
+            tnf_task.goal_state[var_id] = tnf_task.initial_state[var_id];
         }
     }
 
@@ -124,6 +184,20 @@ TNFTask create_tnf_task(const TaskProxy &sas_task) {
         }
     }
 
+    int num_relevant_variables = count(relevant.begin(), relevant.end(), true);
+    if (num_relevant_variables < num_sas_variables) {
+        tnf_task.irrelevant_variables.reserve(num_sas_variables);
+        for (bool is_relevant : relevant) {
+            tnf_task.irrelevant_variables.push_back(!is_relevant);
+        }
+    }
+    int num_relevant_operators = count_if(
+        tnf_task.operators.begin(), tnf_task.operators.begin() + sas_operators.size(),
+        [](const TNFOperator &op) {return !op.entries.empty(); });
+    g_log << "TNF relevance analysis: " << num_relevant_variables << "/"
+          << num_sas_variables << " relevant variables, " << num_relevant_operators
+          << "/" << sas_operators.size() << " relevant operators" << endl;
+
     return tnf_task;
 }
 }
@@ -59,6 +59,19 @@ struct TNFTask {
     // All operators are in TNF (see documentation above).
     std::vector<TNFOperator> operators;
 
+    /*
+      irrelevant_variables[v] is true if variable v cannot influence
+      whether the goal is reached (see create_tnf_task). No operator
+      mentions such a variable, and projections map all of its values to a
+      single abstract value. An empty vector means that all variables are
+      relevant.
+    */
+    std::vector<bool> irrelevant_variables;
+
+    bool is_relevant(int var) const {
+        return irrelevant_variables.empty() || !irrelevant_variables[var];
+    }
+
     int get_num_states() const {
         int result = 1;
         for (int d : variable_domains) {
@@ -68,6 +81,14 @@ struct TNFTask {
     }
 };
 
+/*
+  Convert the task into TNF. A backward relevance analysis first computes
+  the variables that occur in the goal or in a precondition of an operator
+  that changes a relevant variable. Operators that change no relevant
+  variable lose all entries, and entries of irrelevant variables are
+  dropped from the remaining operators. Variables and operators keep their
+  ids, so states and operator ids of the original task can still be used.
+*/
 extern TNFTask create_tnf_task(const TaskProxy &sas_task);
 
 }
@@ -0,0 +1,100 @@
+#include "zero_one_pdbs.h"
+
+#include "canonical_pdbs.h"
+#include "cost_partitioning.h"
+
+#include "../utils/logging.h"
+#include "../utils/memory.h"
+#include "../utils/timer.h"
+
+#include <atomic>
+#include <cassert>
+#include <limits>
+#include <thread>
+
+using namespace std;
+
+namespace planopt_heuristics {
+static vector<vector<int>> compute_zero_one_costs(
+    const TNFTask &task, const vector<Pattern> &patterns) {
+    vector<vector<int>> costs(patterns.size(), vector<int>(task.operators.size(), 0));
+    for (size_t op_id = 0; op_id < task.operators.size(); ++op_id) {
+        const TNFOperator &op = task.operators[op_id];
+        for (size_t i = 0; i < patterns.size(); ++i) {
+            if (affects_pattern(op, patterns[i])) {
+                costs[i][op_id] = op.cost;
+                break;
+            }
+        }
+    }
+    return costs;
+}
+
+ZeroOnePDBs::ZeroOnePDBs(
+    const TNFTask &task, const vector<Pattern> &patterns, int num_threads) {
+    assert(num_threads >= 1);
+    utils::Timer timer;
+    vector<vector<int>> costs = compute_zero_one_costs(task, patterns);
+
+    vector<unique_ptr<PatternDatabase>> built_pdbs(patterns.size());
+    atomic<size_t> next_pdb(0);
+    auto build_pdbs = [&]() {
+            for (size_t i = next_pdb++; i < patterns.size(); i = next_pdb++) {
+                built_pdbs[i] = utils::make_unique_ptr<PatternDatabase>(
+                    create_task_with_costs(task, costs[i]), patterns[i]);
+            }
+        };
+    if (num_threads == 1) {
+        build_pdbs();
+    } else {
+        vector<thread> threads;
+        for (int i = 0; i < num_threads; ++i) {
+            threads.emplace_back(build_pdbs);
+        }
+        for (thread &t : threads) {
+            t.join();
+        }
+    }
+
+    pdbs.reserve(patterns.size());
+    for (unique_ptr<PatternDatabase> &pdb : built_pdbs) {
+        pdbs.push_back(move(*pdb));
+    }
+    bank = utils::make_unique_ptr<PDBBank>(pdbs);
+    construction_time = timer();
+}
+
+int ZeroOnePDBs::compute_heuristic(const TNFState &original_state) {
+    bank->compute_abstract_state_indices(original_state, abstract_state_indices);
+    bank->lookup_distances(abstract_state_indices, heuristic_values);
+    int h = 0;
+    for (int value : heuristic_values) {
+        if (value == numeric_limits<int>::max())
+            return numeric_limits<int>::max();
+        h += value;
+    }
+    return h;
+}
+
+vector<Pattern> ZeroOnePDBs::get_patterns() const {
+    vector<Pattern> patterns;
+    for (const PatternDatabase &pdb : pdbs) {
+        patterns.push_back(pdb.get_pattern());
+    }
+    return patterns;
+}
+
+size_t ZeroOnePDBs::get_table_bytes() const {
+    return bank->get_memory_usage_in_bytes();
+}
+
+void ZeroOnePDBs::print_statistics() const {
+    for (const PatternDatabase &pdb : pdbs) {
+        pdb.print_statistics();
+    }
+    g_log << "Zero-one PDBs statistics: pdbs=" << pdbs.size()
+          << " table_bytes=" << get_table_bytes()
+          << " construction_time=" << construction_time << "s"
+          << endl;
+}
+}
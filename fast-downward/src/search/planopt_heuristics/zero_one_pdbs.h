@@ -0,0 +1,39 @@
+#ifndef PLANOPT_HEURISTICS_ZERO_ONE_PDBS_H
+#define PLANOPT_HEURISTICS_ZERO_ONE_PDBS_H
+
+#include "pdb.h"
+#include "pdb_bank.h"
+
+#include <memory>
+#include <vector>
+
+namespace planopt_heuristics {
+/*
+  Additive PDBs under a zero-one cost partitioning: each operator keeps its
+  full cost in the first pattern of the given order that it affects and
+  gets cost 0 in all other patterns. The sum of the resulting PDBs is
+  admissible, so evaluating a state only needs one lookup per PDB and no
+  clique computation.
+
+  The PDBs do not depend on each other, so they can be built in parallel.
+*/
+class ZeroOnePDBs {
+    std::vector<PatternDatabase> pdbs;
+    std::unique_ptr<PDBBank> bank;
+    std::vector<int> abstract_state_indices;
+    std::vector<int> heuristic_values;
+    double construction_time;
+public:
+    // The patterns are given in the order in which they receive costs.
+    ZeroOnePDBs(const TNFTask &task, const std::vector<Pattern> &patterns,
+                int num_threads);
+
+    int compute_heuristic(const TNFState &original_state);
+
+    std::vector<Pattern> get_patterns() const;
+    std::size_t get_table_bytes() const;
+    void print_statistics() const;
+};
+}
+
+#endif
@@ -0,0 +1,272 @@
+#! /usr/bin/env python3
+
+"""
+Run the planner experiments of exercises (c), (e) and (g) in parallel and
+collect the results in machine-readable form.
+
+Every run gets its own directory under <output-dir>/<experiment>/runs/ with
+the planner log and the statistics records written by the planopt
+heuristics (planopt_statistics.jsonl, see statistics_report.h). Each run is
+limited in CPU time and memory like the old scripts (ulimit -t / -v). Runs
+that hit a limit are reported with the status "timeout" or "out-of-memory"
+instead of breaking the evaluation.
+
+The results of all runs are written to <output-dir>/<experiment>.csv and
+<output-dir>/<experiment>.jsonl.
+
+Example:
+    ./scripts/run_experiments.py e --jobs 4 --time-limit 60
+"""
+
+import argparse
+import concurrent.futures
+import csv
+import glob
+import json
+import os
+import re
+import resource
+import signal
+import subprocess
+import sys
+
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PLANNER = os.path.join(REPO, "fast-downward", "fast-downward.py")
+STATISTICS_FILE = "planopt_statistics.jsonl"
+
+# Exit codes of the search component (old and new numbering).
+TIMEOUT_EXIT_CODES = {7, 23}
+OUT_OF_MEMORY_EXIT_CODES = {6, 22}
+
+LOG_PATTERNS = {
+    "expanded": r"Expanded until last jump: (\d+) state",
+    "evaluations": r"Evaluated (\d+) state",
+    "dead_ends": r"Dead ends: (\d+) state",
+    "search_time": r"Search time: ([\d.]+)s",
+    "total_time": r"Total time: ([\d.]+)s",
+    "plan_cost": r"Plan cost: (\d+)",
+    "peak_memory_kb": r"Peak memory: (\d+) KB",
+}
+
+CSV_FIELDS = [
+    "experiment", "instance", "k", "config", "status", "exit_code",
+    "plan_cost", "expanded", "evaluations", "dead_ends",
+    "search_time", "total_time", "peak_memory_kb",
+    "planopt_construction_time", "planopt_table_bytes", "planopt_initial_h",
+    "planopt_patterns", "pattern",
+]
+
+
+def castle_instances():
+    return sorted(glob.glob(os.path.join(REPO, "castle", "castle-8-5-*-cards.pddl")),
+                  key=lambda path: int(re.search(r"8-5-(\d+)-cards", path).group(1)))
+
+
+def nomystery_instances():
+    return [os.path.join(REPO, "nomystery-opt11-strips", "p%02d.pddl" % i)
+            for i in range(1, 11)]
+
+
+def instance_name(path):
+    return os.path.splitext(os.path.basename(path))[0]
+
+
+def jobs_for_c():
+    for k in [1000, 100000]:
+        for instance in castle_instances():
+            extraction = (
+                "astar(pdb(pattern=greedy(%d)), bound=0)" % k, "Greedy pattern: ")
+            yield dict(instance=instance, k=k, config="builtin", build="release64",
+                       search="astar(pdb(pattern=greedy(%d)))" % k)
+            yield dict(instance=instance, k=k, config="planopt", build="release64",
+                       extraction=extraction,
+                       search="astar(planopt_pdb(pattern={pattern}, write_statistics=true))")
+
+
+def jobs_for_e():
+    for k in [1000]:
+        for instance in nomystery_instances():
+            extraction = (
+                "astar(cpdbs(patterns=combo(%d)), bound=0)" % k,
+                "Combo pattern collection: ")
+            yield dict(instance=instance, k=k, config="builtin", build="release64",
+                       search="astar(cpdbs(patterns=combo(%d)))" % k)
+            yield dict(instance=instance, k=k, config="builtin-pdb", build="release64",
+                       search="astar(pdb(pattern=greedy(%d)))" % k)
+            yield dict(instance=instance, k=k, config="planopt", build="release64",
+                       extraction=extraction,
+                       search="astar(planopt_cpdbs(patterns={pattern}, write_statistics=true))")
+
+
+def jobs_for_g():
+    for k in [1000, 100000]:
+        for instance in nomystery_instances():
+            yield dict(instance=instance, k=k, config="builtin", build=None,
+                       search="astar(ipdb(collection_max_size=%d, min_improvement=1))" % k)
+            yield dict(instance=instance, k=k, config="planopt", build=None,
+                       search="astar(planopt_ipdb(size_bound=%d, write_statistics=true))" % k)
+
+
+EXPERIMENTS = {
+    "c": jobs_for_c,
+    "e": jobs_for_e,
+    "g": jobs_for_g,
+}
+
+
+def set_limits(time_limit, memory_limit_kb):
+    def preexec():
+        resource.setrlimit(resource.RLIMIT_CPU, (time_limit, time_limit + 5))
+        memory = memory_limit_kb * 1024
+        resource.setrlimit(resource.RLIMIT_AS, (memory, memory))
+    return preexec
+
+
+def run_planner(job, search, run_dir, log_name, time_limit, memory_limit_kb):
+    cmd = [sys.executable, PLANNER]
+    if job["build"]:
+        cmd.append("--build=" + job["build"])
+    cmd += [job["instance"], "--search", search]
+    with open(os.path.join(run_dir, log_name), "w") as log:
+        try:
+            process = subprocess.run(
+                cmd, cwd=run_dir, stdout=log, stderr=subprocess.STDOUT,
+                preexec_fn=set_limits(time_limit, memory_limit_kb),
+                # The CPU limit should trigger first; this catches hanging runs.
+                timeout=2 * time_limit + 30)
+            exit_code = process.returncode
+        except subprocess.TimeoutExpired:
+            exit_code = None
+    with open(os.path.join(run_dir, log_name)) as log:
+        return exit_code, log.read()
+
+
+def get_status(exit_code, output):
+    if "Solution found" in output:
+        return "solved"
+    if "Search stopped without finding a solution" in output or \
+            "Completely explored state space" in output:
+        return "unsolvable"
+    if exit_code is None or exit_code in TIMEOUT_EXIT_CODES or \
+            exit_code in (-signal.SIGXCPU, -signal.SIGKILL):
+        return "timeout"
+    if exit_code in OUT_OF_MEMORY_EXIT_CODES or "bad_alloc" in output or \
+            "MemoryError" in output:
+        return "out-of-memory"
+    return "error"
+
+
+def parse_log(output):
+    result = {}
+    for key, pattern in LOG_PATTERNS.items():
+        matches = re.findall(pattern, output)
+        if matches:
+            value = matches[-1]
+            result[key] = float(value) if "." in value else int(value)
+    return result
+
+
+def read_planopt_statistics(run_dir):
+    """Return the last statistics record with keys prefixed by 'planopt_'."""
+    path = os.path.join(run_dir, STATISTICS_FILE)
+    if not os.path.exists(path):
+        return {}
+    record = None
+    with open(path) as statistics:
+        for line in statistics:
+            try:
+                record = json.loads(line)
+            except ValueError:
+                # The last line can be cut off if the run was killed.
+                pass
+    if record is None:
+        return {}
+    return {"planopt_" + key: value for key, value in record.items()}
+
+
+def run_job(experiment, job_id, job, output_dir, time_limit, memory_limit_kb):
+    run_dir = os.path.join(output_dir, experiment, "runs", job_id)
+    os.makedirs(run_dir, exist_ok=True)
+    for stale in [STATISTICS_FILE]:
+        if os.path.exists(os.path.join(run_dir, stale)):
+            os.remove(os.path.join(run_dir, stale))
+    result = dict(experiment=experiment, instance=instance_name(job["instance"]),
+                  k=job["k"], config=job["config"])
+
+    search = job["search"]
+    if "extraction" in job:
+        extraction_search, prefix = job["extraction"]
+        _, output = run_planner(job, extraction_search, run_dir, "extraction.log",
+                                time_limit, memory_limit_kb)
+        match = re.search(re.escape(prefix) + r"(.*)", output)
+        if not match:
+            result["status"] = "no-pattern"
+            return result
+        result["pattern"] = match.group(1).strip()
+        search = search.format(pattern=result["pattern"])
+
+    exit_code, output = run_planner(job, search, run_dir, "run.log",
+                                    time_limit, memory_limit_kb)
+    result["exit_code"] = exit_code
+    result["status"] = get_status(exit_code, output)
+    result.update(parse_log(output))
+    result.update(read_planopt_statistics(run_dir))
+    return result
+
+
+def write_results(results, output_dir, experiment):
+    csv_path = os.path.join(output_dir, experiment + ".csv")
+    with open(csv_path, "w", newline="") as csv_file:
+        writer = csv.DictWriter(csv_file, fieldnames=CSV_FIELDS, extrasaction="ignore")
+        writer.writeheader()
+        for result in results:
+            row = dict(result)
+            if "planopt_patterns" in row:
+                row["planopt_patterns"] = json.dumps(row["planopt_patterns"])
+            writer.writerow(row)
+    jsonl_path = os.path.join(output_dir, experiment + ".jsonl")
+    with open(jsonl_path, "w") as jsonl_file:
+        for result in results:
+            jsonl_file.write(json.dumps(result) + "\n")
+    return csv_path, jsonl_path
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("experiment", choices=sorted(EXPERIMENTS))
+    parser.add_argument("--jobs", type=int, default=os.cpu_count(),
+                        help="number of runs in parallel (default: number of cores)")
+    parser.add_argument("--time-limit", type=int, default=60,
+                        help="CPU time limit per run in seconds (default: %(default)s)")
+    parser.add_argument("--memory-limit", type=int, default=2000000,
+                        help="memory limit per run in KB (default: %(default)s)")
+    parser.add_argument("--output-dir", default=os.path.join(REPO, "results"),
+                        help="directory for the results (default: %(default)s)")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    jobs = list(EXPERIMENTS[args.experiment]())
+    results = []
+    with concurrent.futures.ProcessPoolExecutor(max_workers=args.jobs) as executor:
+        futures = {}
+        for index, job in enumerate(jobs):
+            job_id = "%03d-%s-%s-%s" % (
+                index, instance_name(job["instance"]), job["k"], job["config"])
+            future = executor.submit(run_job, args.experiment, job_id, job,
+                                     args.output_dir, args.time_limit, args.memory_limit)
+            futures[future] = index
+        for future in concurrent.futures.as_completed(futures):
+            result = future.result()
+            results.append((futures[future], result))
+            print("%(instance)s k=%(k)s %(config)s: %(status)s" % result, flush=True)
+    results = [result for _, result in sorted(results, key=lambda item: item[0])]
+    csv_path, jsonl_path = write_results(results, args.output_dir, args.experiment)
+    print("Wrote %s and %s" % (csv_path, jsonl_path))
+
+
+if __name__ == "__main__":
+    main()